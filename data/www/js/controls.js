@@ -16,6 +16,93 @@
 
 // Marquee controls
 
+// Sends a control's form, keeping at most one request in flight per control.
+// Changes that come in meanwhile (e.g. while dragging) are folded into one
+// request with the latest value, sent once the last one is done.
+const inFlight = {};
+function postControl(url, formId) {
+    if (inFlight[url]) {
+        inFlight[url].pending = formId;
+        return;
+    }
+
+    inFlight[url] = {};
+    fetch(url, {
+        method: "POST",
+        headers: { "X-Requested-With": "fetch" },
+        body: new FormData(document.getElementById(formId))
+    }).finally(() => {
+        const pending = inFlight[url].pending;
+        delete inFlight[url];
+        if (pending) postControl(url, pending);
+    });
+}
+
+// Live preview of the display, and a faster way to send controls while it's
+// open. See preview.h for the frame format.
+const canvas = document.getElementById("preview");
+const context = canvas.getContext("2d");
+let image = null;
+let socket = null;
+
+function drawPreview(frame) {
+    const bytes = new Uint8Array(frame);
+    const width = bytes[1] | bytes[2] << 8;
+    const height = bytes[3] | bytes[4] << 8;
+    if (bytes[0] == "K".charCodeAt(0) || !image) {
+        canvas.width = width;
+        canvas.height = height;
+        image = context.createImageData(width, height);
+        for (let i = 3; i < image.data.length; i += 4) image.data[i] = 255;
+    }
+
+    // Pixels go up each column from the bottom, and the canvas goes down
+    // each row from the top
+    const setPixel = (p, r, g, b) => {
+        const x = Math.floor(p / height);
+        const y = height - 1 - p % height;
+        const i = (y * width + x) * 4;
+        image.data[i] = r;
+        image.data[i + 1] = g;
+        image.data[i + 2] = b;
+    };
+
+    let p = 0;
+    for (let i = 5; i < bytes.length;) {
+        const token = bytes[i++];
+        if (token < 0x80) {
+            p += token + 1;
+            continue;
+        }
+        for (let n = token - 0x7f; n > 0; n--) {
+            setPixel(p++, bytes[i], bytes[i + 1], bytes[i + 2]);
+        }
+        i += 3;
+    }
+    context.putImageData(image, 0, 0);
+}
+
+function connect() {
+    socket = new WebSocket(`ws://${location.host}/ws`);
+    socket.binaryType = "arraybuffer";
+    socket.onmessage = (e) => drawPreview(e.data);
+    socket.onclose = () => {
+        socket = null;
+        image = null;
+        setTimeout(connect, 2000);
+    };
+}
+connect();
+
+// Sends a control over the WebSocket if it's open, or else as a form post
+function sendControl(message, url, formId) {
+    if (socket && socket.readyState == WebSocket.OPEN) {
+        socket.send(JSON.stringify(message));
+    } else {
+        postControl(url, formId);
+    }
+}
+
 // Instantiate color selector
 var hueb = new Huebee('#color-input', {
     // options
@@ -25,22 +112,17 @@ var hueb = new Huebee('#color-input', {
 });
 
 hueb.on('change', function (color, hue, sat, lum) {
-    fetch("/color", {
-        method: "POST",
-        body: new FormData(document.getElementById("color-form"))
-    });
+    // Huebee shortens colors like #ff8800 to #f80
+    let hex = color.slice(1);
+    if (hex.length == 3) hex = hex.replace(/./g, "$&$&");
+    sendControl({ color: hex }, "/color", "color-form");
 });
 
 document.getElementById("brightness-input").addEventListener("change", (e) => {
-    fetch("/brightness", {
-        method: "POST",
-        body: new FormData(document.getElementById("brightness-form"))
-    });
+    sendControl({ brightness: Number(e.target.value) }, "/brightness",
+        "brightness-form");
 });
 
 document.getElementById("speed-input").addEventListener("change", (e) => {
-    fetch("/speed", {
-        method: "POST",
-        body: new FormData(document.getElementById("speed-form"))
-    });
+    sendControl({ speed: Number(e.target.value) }, "/speed", "speed-form");
 });
@@ -14,58 +14,262 @@
 
 #include "interpolate.h"
 
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
 #include <charconv>
+#include <cstddef>
 #include <string>
 #include <string_view>
 
+#include "markup.h"
+
 namespace led_marquee {
 
-std::string Interpolate(std::string_view input) {
-  std::string output;
+namespace {
+
+// Finds the next '{', or byte that would read as an op, four bytes at a time.
+// Most text has no escapes at all, so this is where the time goes.
+std::size_t FindSpecial(std::string_view input) {
+  constexpr uint32_t kOnes = 0x01010101;
+  constexpr uint32_t kHighBits = 0x80808080;
+  constexpr uint32_t kBraces = kOnes * '{';
+
+  std::size_t i = 0;
+  for (; i + sizeof(uint32_t) <= input.size(); i += sizeof(uint32_t)) {
+    uint32_t word;
+    memcpy(&word, input.data() + i, sizeof(word));
+    // Ops all have the high bit set, so look closer at any byte that does
+    if (word & kHighBits) break;
+    // Any byte that was a '{' is now zero, which sets its high bit here
+    const uint32_t x = word ^ kBraces;
+    if ((x - kOnes) & ~x & kHighBits) break;
+  }
+  for (; i < input.size(); i++) {
+    if (input[i] == '{' || markup::IsOp(input[i])) return i;
+  }
+  return std::string_view::npos;
+}
+
+// Writes to a fixed-size buffer, counting whatever doesn't fit
+class BoundedWriter {
+ public:
+  BoundedWriter(char *output, std::size_t size)
+      : output_(output), size_(size){};
+
+  void Append(std::string_view text) {
+    if (length_ < size_) {
+      const std::size_t n = std::min(text.size(), size_ - length_);
+      memcpy(output_ + length_, text.data(), n);
+    }
+    length_ += text.size();
+  };
+  void Append(char c) {
+    if (length_ < size_) output_[length_] = c;
+    length_++;
+  };
+
+  std::size_t length() const { return length_; };
+
+ private:
+  char *output_;
+  std::size_t size_;
+  std::size_t length_ = 0;
+};
+
+// Does the same to a string
+class StringWriter {
+ public:
+  explicit StringWriter(std::string &output) : output_(output){};
+
+  void Append(std::string_view text) { output_.append(text); };
+  void Append(char c) { output_.push_back(c); };
+
+ private:
+  std::string &output_;
+};
+
+struct NamedColor {
+  const char *name;
+  uint32_t rgb;
+};
+
+constexpr NamedColor kNamedColors[] = {
+    {"red", 0xff0000},    {"green", 0x00ff00},   {"blue", 0x0000ff},
+    {"white", 0xffffff},  {"yellow", 0xffff00},  {"cyan", 0x00ffff},
+    {"magenta", 0xff00ff}, {"orange", 0xff8000}, {"purple", 0x8000ff},
+    {"pink", 0xff60a0},
+};
+
+// Longest markup worth looking at, braces included
+constexpr std::size_t kMaxMarkup = 64;
+
+// Parses all of `text` as a number, like from_chars()
+template <typename T>
+bool ParseNumber(std::string_view text, T &value, int base = 10) {
+  auto [ptr, err] =
+      std::from_chars(text.data(), text.data() + text.size(), value, base);
+  return err == std::errc{} && ptr == text.data() + text.size() &&
+         !text.empty();
+}
+
+template <typename Writer>
+void AppendColor(Writer &output, uint32_t rgb) {
+  output.Append(markup::kColor);
+  output.Append(static_cast<char>((rgb >> 16) & 0xff));
+  output.Append(static_cast<char>((rgb >> 8) & 0xff));
+  output.Append(static_cast<char>(rgb & 0xff));
+}
+
+// The spec of a field is just the markup without the braces
+template <typename Writer>
+void AppendField(Writer &output, std::string_view spec) {
+  output.Append(markup::kField);
+  output.Append(static_cast<char>(spec.size()));
+  output.Append(spec);
+}
+
+template <typename Writer>
+void AppendWithMilliseconds(Writer &output, char op, uint16_t ms) {
+  output.Append(op);
+  output.Append(static_cast<char>(ms >> 8));
+  output.Append(static_cast<char>(ms & 0xff));
+}
+
+// Writes the op for `tag`, the part between the braces. Returns false if it
+// isn't valid markup.
+template <typename Writer>
+bool CompileTag(std::string_view tag, Writer &output) {
+  if (tag.size() == 7 && tag[0] == '#') {
+    uint32_t rgb;
+    if (!ParseNumber(tag.substr(1), rgb, 16)) return false;
+    AppendColor(output, rgb);
+    return true;
+  }
+
+  if (tag == "blink" || tag == "/blink") {
+    output.Append(markup::kBlink);
+    output.Append(tag[0] == '/' ? '\0' : '\1');
+    return true;
+  }
 
+  if (tag == "speed") {
+    AppendWithMilliseconds(output, markup::kSpeed, 0);
+    return true;
+  }
+
+  if (tag == "time" || tag == "date" || tag == "uptime") {
+    AppendField(output, tag);
+    return true;
+  }
+
+  for (const auto &color : kNamedColors) {
+    if (tag == color.name) {
+      AppendColor(output, color.rgb);
+      return true;
+    }
+  }
+
+  const auto colon = tag.find(':');
+  if (colon == std::string_view::npos) return false;
+  const auto name = tag.substr(0, colon);
+  const auto arg = tag.substr(colon + 1);
+
+  if (name == "speed" || name == "pause") {
+    uint16_t ms;
+    if (!ParseNumber(arg, ms) || ms == 0) return false;
+    AppendWithMilliseconds(
+        output, name == "speed" ? markup::kSpeed : markup::kPause, ms);
+    return true;
+  }
+
+  if (name == "time" || name == "date" || name == "topic") {
+    if (arg.empty()) return false;
+    AppendField(output, tag);
+    return true;
+  }
+
+  if (name == "icon") {
+    const int icon = markup::FindIcon(arg);
+    if (icon < 0) return false;
+    output.Append(markup::kIcon);
+    output.Append(static_cast<char>(icon));
+    return true;
+  }
+
+  if (name == "hsv") {
+    uint8_t hsv[3];
+    std::string_view rest = arg;
+    for (int i = 0; i < 3; i++) {
+      const auto comma = i < 2 ? rest.find(',') : rest.size();
+      if (comma == std::string_view::npos) return false;
+      if (!ParseNumber(rest.substr(0, comma), hsv[i])) return false;
+      rest.remove_prefix(std::min(comma + 1, rest.size()));
+    }
+    output.Append(markup::kHsv);
+    for (uint8_t part : hsv) output.Append(static_cast<char>(part));
+    return true;
+  }
+
+  return false;
+}
+
+template <typename Writer>
+void InterpolateTo(std::string_view input, Writer &output) {
   while (!input.empty()) {
-    auto pos = input.find('{');
+    auto pos = FindSpecial(input);
     if (pos == std::string_view::npos) {
-      // No (more) escapes, so we're done
-      output.append(input);
-      return output;
-    } else {
-      // Grab the part of the string before the escape sequence
-      output.append(input, 0, pos);
-      input.remove_prefix(pos);
-
-      // Does it even look like `{#aabbcc}`?
-      if (input.length() >= 9 && input[1] == '#' && input[8] == '}') {
-        // Try to convert hex to RGB
-        unsigned long rgbl{};
-        auto [ptr, err] =
-            std::from_chars(input.data() + 2, input.data() + 2 + 6, rgbl, 16);
-        if (err == std::errc{} && ptr == input.data() + 2 + 6) {
-          // Consume the interpolated string
-          input.remove_prefix(9);
-
-          // Put the escape sequence into the output
-          uint8_t b = rgbl & 0xff;
-          uint8_t g = (rgbl >> 8) & 0xff;
-          uint8_t r = (rgbl >> 16) & 0xff;
-          output.push_back('\xe0');
-          output.push_back(r);
-          output.push_back(g);
-          output.push_back(b);
-        } else {
-          // Reject invalid input
-          output.push_back(input.front());
-          input.remove_prefix(1);
-        }
-      } else {
-        // Not a real escape sequence, so output the '{'
-        output.push_back(input.front());
+      // No (more) markup, so we're done
+      output.Append(input);
+      return;
+    }
+
+    // Grab the part of the string before the markup
+    output.Append(input.substr(0, pos));
+    input.remove_prefix(pos);
+
+    if (markup::IsOp(input.front())) {
+      // Only markup gets to make ops. This is most likely the start of a
+      // UTF-8 character, so the rest of it goes too.
+      output.Append('?');
+      input.remove_prefix(1);
+      while (!input.empty() && (input.front() & 0xc0) == 0x80) {
         input.remove_prefix(1);
       }
+      continue;
+    }
+
+    // Does it even look like `{...}`?
+    const auto close = input.substr(0, kMaxMarkup).find('}');
+    if (close != std::string_view::npos &&
+        CompileTag(input.substr(1, close - 1), output)) {
+      // Consume the markup
+      input.remove_prefix(close + 1);
+    } else {
+      // Not real markup, so output the '{'
+      output.Append(input.front());
+      input.remove_prefix(1);
     }
   }
+}
+
+}  // namespace
 
+std::string Interpolate(std::string_view input) {
+  // Compiled markup is never longer than its source
+  std::string output;
+  output.reserve(input.size());
+  StringWriter writer(output);
+  InterpolateTo(input, writer);
   return output;
 }
 
+std::size_t Interpolate(std::string_view input, char *output,
+                        std::size_t output_size) {
+  BoundedWriter writer(output, output_size);
+  InterpolateTo(input, writer);
+  return writer.length();
+}
+
 }  // namespace led_marquee
@@ -17,13 +17,42 @@
 #ifndef LED_MARQUEE_INTERPOLATE_H_
 #define LED_MARQUEE_INTERPOLATE_H_
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 
 namespace led_marquee {
 
+// Compiles the markup in a message into the ops in markup.h:
+//
+//   {#rrggbb}         Text color, in hex
+//   {red}             Named text color (see kNamedColors in interpolate.cpp)
+//   {hsv:h,s,v}       Text color, each part 0-255
+//   {speed:ms}        Scroll speed from here on, in milliseconds per column
+//   {speed}           Back to the usual scroll speed
+//   {pause:ms}        Stop scrolling for a while once this point is in view
+//   {blink} {/blink}  Blink the text in between
+//   {icon:name}       One of markup::kIcons
+//   {time:format}     The time, formatted by strftime(); "%H:%M" by default
+//   {date:format}     The same, but "%Y-%m-%d" by default
+//   {uptime}          Time since startup
+//   {topic:name}      The last payload seen on an MQTT topic
+//
+// Fields (the last four) are filled in on the display, as they scroll into
+// view, so they stay up to date.
+//
+// Anything else in braces is left alone. Bytes that would read as ops can't
+// get through as they are: each becomes '?', taking the rest of its UTF-8
+// character with it, so e.g. "5\u20ac" comes out as "5?".
 std::string Interpolate(std::string_view input);
 
+// Writes the interpolated `input` into `output`, without allocating. Returns
+// the full length of the result, like snprintf(): if that's more than
+// `output_size`, only the first `output_size` characters were written. The
+// result is not NUL terminated.
+std::size_t Interpolate(std::string_view input, char *output,
+                        std::size_t output_size);
+
 }  // namespace led_marquee
 
 #endif  // LED_MARQUEE_INTERPOLATE_H_
@@ -0,0 +1,57 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "markup.h"
+
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+
+namespace led_marquee {
+namespace markup {
+
+const Icon kIcons[] = {
+    {"heart", 7, {0x06, 0x0f, 0x1f, 0x3e, 0x1f, 0x0f, 0x06}},
+    {"up", 5, {0x04, 0x02, 0x7f, 0x02, 0x04}},
+    {"down", 5, {0x10, 0x20, 0x7f, 0x20, 0x10}},
+    {"left", 7, {0x04, 0x0e, 0x15, 0x04, 0x04, 0x04, 0x04}},
+    {"right", 7, {0x04, 0x04, 0x04, 0x04, 0x15, 0x0e, 0x04}},
+    {"degree", 3, {0x02, 0x05, 0x02}},
+};
+
+const std::size_t kNumIcons = std::size(kIcons);
+
+int FindIcon(std::string_view name) {
+  for (std::size_t i = 0; i < kNumIcons; i++) {
+    if (name == kIcons[i].name) return static_cast<int>(i);
+  }
+  return -1;
+}
+
+std::size_t CompleteLength(std::string_view text) {
+  std::size_t i = 0;
+  while (i < text.size()) {
+    if (!IsOp(text[i])) {
+      i++;
+      continue;
+    }
+    const std::size_t size = OpSize(text.substr(i));
+    if (size == 0) break;
+    i += size;
+  }
+  return i;
+}
+
+}  // namespace markup
+}  // namespace led_marquee
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_MARKUP_H_
+#define LED_MARQUEE_MARKUP_H_
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <string_view>
+
+namespace led_marquee {
+
+// The compiled form of message markup, as produced by Interpolate(). Text
+// passes through as it is, except for these bytes, which each start an op
+// followed by its arguments.
+namespace markup {
+
+constexpr char kColor = '\xe0';  // Red, green, blue
+constexpr char kSpeed = '\xe1';  // Milliseconds per column, high byte first;
+                                 // zero goes back to the usual speed
+constexpr char kPause = '\xe2';  // Milliseconds, high byte first
+constexpr char kBlink = '\xe3';  // Non-zero to start blinking, zero to stop
+constexpr char kIcon = '\xe4';   // Index into kIcons
+constexpr char kHsv = '\xe5';    // Hue, saturation, value
+constexpr char kField = '\xe6';  // Length, then the spec (see Fields)
+
+constexpr bool IsOp(char c) { return c >= kColor && c <= kField; }
+
+// Size of the op at the start of `text`, arguments included. Zero if there
+// isn't one, or it's cut off.
+constexpr std::size_t OpSize(std::string_view text) {
+  if (text.empty()) return 0;
+
+  std::size_t size = 0;
+  switch (text[0]) {
+    case kColor:
+    case kHsv:
+      size = 4;
+      break;
+    case kSpeed:
+    case kPause:
+      size = 3;
+      break;
+    case kBlink:
+    case kIcon:
+      size = 2;
+      break;
+    case kField:
+      if (text.size() < 2) return 0;
+      size = 2 + static_cast<uint8_t>(text[1]);
+      break;
+    default:
+      return 0;
+  }
+  return size <= text.size() ? size : 0;
+}
+
+// Length of `text` without the op cut off at the end, if there is one, e.g.
+// after it's been truncated. The rest of it must be compiled markup.
+std::size_t CompleteLength(std::string_view text);
+
+// A small picture that can go in a message, like a character
+struct Icon {
+  const char *name;
+  uint8_t width;
+  // One bit per row, bit 0 being the top, like a font
+  uint8_t columns[7];
+};
+
+extern const Icon kIcons[];
+extern const std::size_t kNumIcons;
+
+// Index of the named icon, or -1
+int FindIcon(std::string_view name);
+
+}  // namespace markup
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_MARKUP_H_
@@ -26,9 +26,10 @@ import paho.mqtt.client as mqtt
 
 
 def pick_color():
+    """Color markup for the start of a message, so it lasts just that message."""
     hue = random.random()
-    rgb = colorsys.hsv_to_rgb(hue, 1.0, 1.0)
-    return {"r": int(rgb[0] * 255), "g": int(rgb[1] * 255), "b": int(rgb[2] * 255)}
+    r, g, b = (int(c * 255) for c in colorsys.hsv_to_rgb(hue, 1.0, 1.0))
+    return f"{{#{r:02x}{g:02x}{b:02x}}}"
 
 
 def getline(f: io.TextIOBase, n: int):
@@ -39,6 +40,12 @@ def getline(f: io.TextIOBase, n: int):
 
 
 def on_ready(client, userdata, message):
+    # Keep the next message queued up behind the one that's showing, so that
+    # there's no gap between them
+    status = json.loads(message.payload)
+    if status["queue_depth"] > 0 or status["credits"] == 0:
+        return
+
     n = random.randrange(0, userdata["line_count"])
     print(f"chose line {n}:")
 
@@ -48,8 +55,9 @@ def on_ready(client, userdata, message):
     print(chopped_line)
 
     base_topic = userdata["base_topic"]
-    client.publish(f"{base_topic}/set", json.dumps({"color": pick_color()}))
-    client.publish(f"{base_topic}/text", json.dumps({"text": chopped_line}))
+    client.publish(
+        f"{base_topic}/text", json.dumps({"text": pick_color() + chopped_line})
+    )
 
 
 def count_lines(f: io.TextIOBase):
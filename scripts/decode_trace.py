@@ -0,0 +1,113 @@
+# Copyright 2022 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Turns a trace dump from the marquee's /trace into Chrome trace JSON, which
+# chrome://tracing and https://ui.perfetto.dev can show as a timeline. The
+# format is described with WriteTrace() in src/trace.h.
+#
+#   python3 scripts/decode_trace.py --host marquee.local > trace.json
+#   python3 scripts/decode_trace.py --file dump.bin > trace.json
+#
+# Needs nothing outside the standard library.
+
+import argparse
+import json
+import struct
+import sys
+import urllib.request
+
+MAGIC = b"LMTR"
+VERSION = 1
+PID = 1
+
+
+def read_string(data, pos):
+    end = data.index(b"\0", pos)
+    return data[pos:end].decode(), end + 1
+
+
+def decode(data):
+    """Returns the Chrome trace events in a dump."""
+    if data[:4] != MAGIC or data[4] != VERSION:
+        raise ValueError("Not a version 1 marquee trace")
+    num_events, num_threads = data[5], data[6]
+    # Skips when the dump was taken, which nothing here needs
+    pos = 12
+
+    events = []
+    for _ in range(num_events):
+        phase = chr(data[pos])
+        name, pos = read_string(data, pos + 1)
+        arg_name, pos = read_string(data, pos)
+        events.append((phase, name, arg_name))
+
+    trace = []
+    for tid in range(num_threads):
+        name, pos = read_string(data, pos)
+        trace.append({"ph": "M", "name": "thread_name", "pid": PID,
+                      "tid": tid, "args": {"name": name}})
+
+    (count,) = struct.unpack_from("<I", data, pos)
+    pos += 4
+    records = [struct.unpack_from("<IBBxxI", data, pos + i * 12)
+               for i in range(count)]
+
+    # Times are microseconds since startup, which wrap every 71 minutes.
+    # Records are close to in order, so each is near the last.
+    time = None
+    previous = 0
+    for raw_time, event, thread, arg in records:
+        if time is None:
+            time = raw_time
+        else:
+            delta = (raw_time - previous) & 0xFFFFFFFF
+            time += delta - (1 << 32) if delta & 0x80000000 else delta
+        previous = raw_time
+
+        if event >= len(events):
+            continue
+        phase, name, arg_name = events[event]
+        entry = {"ph": phase, "name": name, "pid": PID, "tid": thread,
+                 "ts": time}
+        if arg_name:
+            entry["args"] = {arg_name: arg}
+        if phase == "i":
+            entry["s"] = "t"
+        trace.append(entry)
+
+    return trace
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Convert a marquee trace dump to Chrome trace JSON"
+    )
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--host", help="Marquee address, to fetch /trace from")
+    source.add_argument("--file", help="Dump saved from /trace")
+    args = parser.parse_args()
+
+    if args.host:
+        with urllib.request.urlopen(f"http://{args.host}/trace") as response:
+            data = response.read()
+    else:
+        with open(args.file, "rb") as f:
+            data = f.read()
+
+    json.dump({"traceEvents": decode(data), "displayTimeUnit": "ms"},
+              sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,109 @@
+# Copyright 2022 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Builds the filesystem image's contents from data/ into .pio/data/, with the
+# web assets gzipped, and points PlatformIO's buildfs/uploadfs at it.
+#
+# The web server sends the .gz files as they are, so they're smaller on flash
+# and on the wire. Each asset gets an ETag from its contents, listed in
+# www.manifest (see asset_manifest.h), and pages refer to scripts and styles
+# with ?v=<etag>, so those can be cached for good.
+#
+# Also runs on its own: python3 scripts/gzip_www.py
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+
+# Anything else is copied as it is
+COMPRESSIBLE = {".html", ".css", ".js", ".json", ".svg", ".txt"}
+MANIFEST = "www.manifest"
+
+
+def etag(data):
+    return hashlib.sha1(data).hexdigest()[:16]
+
+
+def fingerprint(page, etags):
+    """Adds ?v=<etag> to references to other assets in a page."""
+
+    def add_version(match):
+        attribute, path = match.groups()
+        if path not in etags:
+            return match.group(0)
+        return f'{attribute}="{path}?v={etags[path]}"'
+
+    return re.sub(r'(href|src)="(/[^"?#]*)"', add_version,
+                  page.decode()).encode()
+
+
+def build(data_dir, out_dir):
+    shutil.rmtree(out_dir, ignore_errors=True)
+
+    files = {}
+    for root, _, names in os.walk(data_dir):
+        for name in sorted(names):
+            path = os.path.join(root, name)
+            rel = os.path.relpath(path, data_dir).replace(os.sep, "/")
+            with open(path, "rb") as f:
+                files[rel] = f.read()
+
+    # Pages last, so they can refer to everything else by its final contents
+    www = {rel[3:]: data for rel, data in files.items()
+           if rel.startswith("www/")}
+    pages = sorted(path for path in www if path.endswith(".html"))
+    etags = {}
+    manifest = []
+    for path in sorted(www, key=lambda p: p in pages):
+        data = www[path]
+        if path in pages:
+            data = fingerprint(data, etags)
+        etags[path] = etag(data)
+
+        stored_path = "www" + path
+        stored = data
+        if os.path.splitext(path)[1] in COMPRESSIBLE:
+            # mtime=0 so the same input always makes the same image
+            stored = gzip.compress(data, compresslevel=9, mtime=0)
+            stored_path += ".gz"
+        files[stored_path] = stored
+        if stored_path != "www" + path:
+            del files["www" + path]
+        manifest.append(f"{path} {etags[path]} {len(data)} {len(stored)}\n")
+
+    files[MANIFEST] = "".join(manifest).encode()
+
+    for rel, data in files.items():
+        path = os.path.join(out_dir, rel)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, "wb") as f:
+            f.write(data)
+
+    size = sum(len(data) for rel, data in files.items())
+    original = sum(len(data) for data in www.values())
+    print(f"Web assets: {original} bytes, {size} bytes in {out_dir}")
+
+
+try:
+    Import("env")  # noqa: F821 (PlatformIO provides it)
+except NameError:
+    project_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    build(os.path.join(project_dir, "data"),
+          os.path.join(project_dir, ".pio", "data"))
+else:
+    out_dir = os.path.join(env.subst("$PROJECT_WORKSPACE_DIR"), "data")
+    build(env.subst("$PROJECT_DATA_DIR"), out_dir)
+    env.Replace(PROJECT_DATA_DIR=out_dir)
@@ -0,0 +1,74 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "asset_manifest.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace led_marquee {
+
+namespace {
+
+// Takes the next space separated word off the front of `line`
+std::string_view NextWord(std::string_view &line) {
+  const std::size_t end = std::min(line.find(' '), line.size());
+  const std::string_view word = line.substr(0, end);
+  line.remove_prefix(std::min(end + 1, line.size()));
+  return word;
+}
+
+bool ParseSize(std::string_view word, std::size_t &size) {
+  const auto result = std::from_chars(word.data(), word.data() + word.size(),
+                                      size);
+  return result.ec == std::errc() && result.ptr == word.data() + word.size();
+}
+
+}  // namespace
+
+bool AssetManifest::Parse(std::string_view text) {
+  assets_.clear();
+
+  while (!text.empty()) {
+    const std::size_t end = std::min(text.find('\n'), text.size());
+    std::string_view line = text.substr(0, end);
+    text.remove_prefix(std::min(end + 1, text.size()));
+    if (line.empty()) continue;
+
+    Asset asset;
+    asset.path = NextWord(line);
+    asset.etag = NextWord(line);
+    if (asset.path.empty() || asset.path[0] != '/' || asset.etag.empty() ||
+        !ParseSize(NextWord(line), asset.size) ||
+        !ParseSize(NextWord(line), asset.stored_size) || !line.empty()) {
+      assets_.clear();
+      return false;
+    }
+    assets_.push_back(std::move(asset));
+  }
+  return true;
+}
+
+const AssetManifest::Asset *AssetManifest::Find(std::string_view path) const {
+  for (const auto &asset : assets_) {
+    if (asset.path == path) return &asset;
+  }
+  return nullptr;
+}
+
+}  // namespace led_marquee
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_ASSET_MANIFEST_H_
+#define LED_MARQUEE_ASSET_MANIFEST_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace led_marquee {
+
+// The web assets on the filesystem, as listed by scripts/gzip_www.py. Each
+// line is an asset's URL path, its ETag, and its size before and after
+// compression, e.g.
+//
+//   /index.html e08ddb80793818bd 2001 907
+class AssetManifest {
+ public:
+  struct Asset {
+    std::string path;
+    std::string etag;
+    std::size_t size;
+    // What's on the filesystem, and what gets sent
+    std::size_t stored_size;
+  };
+
+  // Replaces the list with the one in `text`. If any of it is malformed, the
+  // list is left empty and this returns false.
+  bool Parse(std::string_view text);
+
+  // The asset at a URL path, or nullptr if there isn't one
+  const Asset *Find(std::string_view path) const;
+
+  const std::vector<Asset> &assets() const { return assets_; }
+  bool empty() const { return assets_.empty(); }
+
+ private:
+  std::vector<Asset> assets_;
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_ASSET_MANIFEST_H_
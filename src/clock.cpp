@@ -14,44 +14,83 @@
 
 #include "clock.h"
 
-#include <FastLED.h>
-#include <LEDText.h>
-#include <string.h>
+#include <stdint.h>
 
+#include <algorithm>
 #include <cstddef>
+#include <string_view>
 
 #include "display_manager.h"
+#include "font.h"
+#include "framebuffer.h"
+#include "rgb.h"
 
 namespace led_marquee {
 
 Clock::Clock(DisplayManager& display_manager, const uint8_t* font_data)
-    : display_manager_(display_manager) {
-  led_text_.SetFont(font_data);
-  led_text_.SetTextColrOptions(COLR_RGB | COLR_SINGLE, 0xff, 0xff, 0xff);
-}
+    : display_manager_(display_manager), font_(font_data) {}
 
 void Clock::Init(const int width, const int height, const int x, const int y) {
   width_ = width;
   height_ = height;
   x_ = x;
   y_ = y;
+  redraw_ = true;
+}
 
-  display_manager_.InitLedText(led_text_, width, height, x, y);
+void Clock::SetColor(Rgb color) {
+  if (color == color_) return;
+  color_ = color;
+  redraw_ = true;
 }
 
-void Clock::SetColorHsv(uint8_t hue, uint8_t saturation, uint8_t value) {
-  led_text_.SetTextColrOptions(COLR_HSV | COLR_SINGLE, hue, saturation, value);
+bool Clock::SetText(std::string_view text) {
+  if (!display_manager_.IsEnabled()) return false;
+
+  bool drew = redraw_;
+  if (redraw_) EraseArea();
+  // Cells past the end of the new text are erased
+  const std::size_t cells = std::max(text.size(), shown_.size());
+  for (std::size_t i = 0; i < cells; i++) {
+    const char c = i < text.size() ? text[i] : '\0';
+    if (!redraw_ && i < shown_.size() && shown_[i] == c) continue;
+    DrawCell(i, c);
+    drew = true;
+  }
+
+  shown_.assign(text);
+  redraw_ = false;
+  return drew;
 }
 
-void Clock::SetText(const String& text) {
-  if (display_manager_.IsEnabled()) {
-    EraseArea();
-    led_text_.SetScrollDirection(SCROLL_LEFT);
-    led_text_.SetText((unsigned char*)text.c_str(), text.length());
-    led_text_.UpdateText();
+void Clock::DrawCell(std::size_t index, char c) {
+  const int advance = font_.Advance();
+  const int cell_x = x_ + static_cast<int>(index) * advance;
+  const int right = x_ + width_;
+  if (cell_x >= right) return;
+
+  display_manager_.FillArea(cell_x, y_, std::min(advance, right - cell_x),
+                            height_);
+  if (c == '\0') return;
+
+  Framebuffer& frame = display_manager_.frame();
+  const int y_begin = std::max(y_, 0);
+  const int y_end = std::min(y_ + height_, frame.Height());
+  // Glyph rows run top down, and the framebuffer's origin is at the bottom
+  const int top = y_ + height_ - 1;
+
+  for (int gx = 0; gx < font_.Width(); gx++) {
+    const int x = cell_x + gx;
+    if (x >= right || x < 0 || x >= frame.Width()) continue;
+
+    const uint32_t bits = font_.Column(static_cast<uint8_t>(c), gx);
+    for (uint32_t lit = bits; lit; lit &= lit - 1) {
+      const int y = top - __builtin_ctz(lit);
+      if (y >= y_begin && y < y_end) frame.At(x, y) = color_;
+    }
   }
 }
 
 void Clock::EraseArea() { display_manager_.FillArea(x_, y_, width_, height_); }
 
-}  // namespace led_marquee
\ No newline at end of file
+}  // namespace led_marquee
@@ -17,14 +17,21 @@
 #ifndef LED_MARQUEE_CLOCK_H_
 #define LED_MARQUEE_CLOCK_H_
 
-#include <LEDText.h>
+#include <stdint.h>
 
 #include <memory>
+#include <string>
+#include <string_view>
 
 #include "display_manager.h"
+#include "font.h"
+#include "rgb.h"
 
 namespace led_marquee {
 
+// Plain text, like the time, in cells one character wide. Setting new text
+// only redraws the characters that changed, so a clock ticking over a second
+// usually redraws one digit.
 class Clock {
  public:
   Clock(DisplayManager &display_manager, const uint8_t *font_data);
@@ -34,15 +41,31 @@ class Clock {
 
   void Init(const int width, const int height, const int x, const int y);
 
-  uint8_t FontHeight() { return led_text_.FontHeight(); };
+  uint8_t FontHeight() { return font_.Height(); };
 
-  void SetColorHsv(uint8_t hue, uint8_t saturation, uint8_t value);
-  void SetText(const String &text);
+  // A new color redraws everything on the next SetText()
+  void SetColor(Rgb color);
+  void SetColorHsv(uint8_t hue, uint8_t saturation, uint8_t value) {
+    SetColor(HsvToRgb(hue, saturation, value));
+  };
+  // Returns false if nothing needed drawing
+  bool SetText(std::string_view text);
   void EraseArea();
+  // Draws everything on the next SetText(), e.g. after something else drew
+  // over it
+  void Redraw() { redraw_ = true; };
 
  private:
+  // Erases the cell at `index` and draws `c` in it
+  void DrawCell(std::size_t index, char c);
+
   DisplayManager &display_manager_;
-  cLEDText led_text_;
+  Font font_;
+  Rgb color_{255, 255, 255};
+
+  // What's on the display now
+  std::string shown_;
+  bool redraw_ = true;
 
   int width_, height_, x_, y_;
 };
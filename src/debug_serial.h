@@ -17,7 +17,9 @@
 #ifndef LED_MARQUEE_DEBUG_SERIAL_H_
 #define LED_MARQUEE_DEBUG_SERIAL_H_
 
-// Set to true to enable serial, which may cause scrolling glitches
+// Set to true to enable serial, which may cause scrolling glitches. To see
+// where the time goes without disturbing it, use the trace ring instead (see
+// trace.h and /trace).
 #define LM_SERIAL_DEBUG 0
 
 #if LM_SERIAL_DEBUG
@@ -14,15 +14,72 @@
 
 #include "display_manager.h"
 
-#include <FastLED.h>
-#include <LEDText.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "framebuffer.h"
 
 namespace led_marquee {
 
+DisplayManager::DisplayManager(std::unique_ptr<DisplayOutput> output,
+                               int width, int height, bool enable_display)
+    : output_(std::move(output)),
+      frame_(width, height),
+      front_(width, height),
+      enable_display_(enable_display),
+      sections_(output_->Sections()) {
+  assert(sections_ > 0 && sections_ <= DisplayOutput::kMaxSections);
+  assert(width % sections_ == 0);
+}
+
 void DisplayManager::SetMaxPower(uint8_t volts, uint32_t max_milliamps) {
-  FastLED.setMaxPowerInVoltsAndMilliamps(volts, max_milliamps);
+  output_->SetMaxPower(volts, max_milliamps);
+  show_all_ = true;
+}
+
+void DisplayManager::SetBrightness(uint8_t brightness) {
+  output_->SetBrightness(brightness);
+  show_all_ = true;
+}
+
+void DisplayManager::Clear(bool show) {
+  frame_.Clear();
+  if (show) Show();
 }
 
-void DisplayManager::SetBrightness(uint8_t brightness) { FastLED.setBrightness(brightness); }
+bool DisplayManager::Show() {
+  // The framebuffer is column-major, so each section is one contiguous run.
+  // Copy rather than swap, because the back buffer is drawn incrementally:
+  // the clock, for one, is only redrawn when it changes.
+  const std::size_t section_size =
+      frame_.size() / static_cast<std::size_t>(sections_);
+  uint32_t dirty_sections = 0;
+  for (int section = 0; section < sections_; section++) {
+    const std::size_t offset = static_cast<std::size_t>(section) * section_size;
+    const Rgb *back = frame_.data() + offset;
+    Rgb *front = front_.data() + offset;
+    if (!std::equal(back, back + section_size, front)) {
+      std::copy(back, back + section_size, front);
+      dirty_sections |= 1u << section;
+    }
+  }
+  if (show_all_) {
+    dirty_sections = ~0u >> (DisplayOutput::kMaxSections - sections_);
+    show_all_ = false;
+  }
+
+  if (dirty_sections == 0) {
+    skipped_shows_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  output_->Show(front_, dirty_sections);
+  return true;
+}
 
-}  // namespace led_marquee
\ No newline at end of file
+}  // namespace led_marquee
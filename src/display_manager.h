@@ -17,57 +17,60 @@
 #ifndef LED_MARQUEE_DISPLAY_MANAGER_H_
 #define LED_MARQUEE_DISPLAY_MANAGER_H_
 
-#include <FastLED.h>
-#include <LEDMatrix.h>
-#include <LEDText.h>
 #include <stdint.h>
 
+#include <atomic>
 #include <memory>
 
+#include "framebuffer.h"
+#include "rgb.h"
+#include "text_renderer.h"
+
 namespace led_marquee {
 
+// Where finished frames go. On the device, this is FastLedOutput; on the host
+// it's whatever wants to look at the pixels (see HostOutput).
+//
+// The display is split into Sections() equal runs of columns, left to right,
+// so that outputs with several LED strings can send only the ones that changed.
+class DisplayOutput {
+ public:
+  static constexpr int kMaxSections = 32;
+
+  virtual ~DisplayOutput() = default;
+
+  virtual int Sections() const { return 1; };
+
+  // Bit n of `dirty_sections` is set if section n has changed since the last
+  // call. Never called with nothing to do.
+  virtual void Show(const Framebuffer &frame, uint32_t dirty_sections) = 0;
+  virtual void SetBrightness(uint8_t /*brightness*/){};
+  virtual void SetMaxPower(uint8_t /*volts*/, uint32_t /*max_milliamps*/){};
+};
+
+// Owns the framebuffers and pushes them out to the display. Drawing goes into
+// the back buffer, frame(); Show() makes it the front buffer, which is what's
+// on the display until the next Show(). Sections that haven't changed since
+// the last Show() aren't sent again, and neither is an unchanged frame.
 class DisplayManager {
  public:
-  // This is not very generalized, but all this use of templates makes it hard
-  // to dynamically instantiate everything.
-  template <template <uint8_t, EOrder> class chipset, const uint8_t data_pins[],
-            EOrder color_order>
-  static std::unique_ptr<DisplayManager> Create(
-      int num_sections, int section_width, int matrix_height,
-      std::shared_ptr<cLEDMatrixBase> leds, bool enable_display) {
-    auto display_manager = std::unique_ptr<DisplayManager>(
-        new DisplayManager(leds, enable_display));
-
-    // This is particularly ugly. To support more sections, this code needs
-    // to be copied and pasted.
-    const int section_pixels = section_width * matrix_height;
-    FastLED.addLeds<chipset, data_pins[0], color_order>((*leds)[0],
-                                                        section_pixels);
-    if (num_sections > 1)
-      FastLED.addLeds<chipset, data_pins[1], color_order>(
-          (*leds)[section_pixels * 1], section_pixels);
-    if (num_sections > 2)
-      FastLED.addLeds<chipset, data_pins[2], color_order>(
-          (*leds)[section_pixels * 2], section_pixels);
-    assert(num_sections < 4);
-
-    // For safety, start with everything off and brightness turned down
-    FastLED.setBrightness(10);
-    FastLED.clear(true);
-
-    return display_manager;
-  };
+  DisplayManager(std::unique_ptr<DisplayOutput> output, int width, int height,
+                 bool enable_display = true);
 
   // Not copyable
   DisplayManager(const DisplayManager& other) = delete;
   DisplayManager& operator=(const DisplayManager& other) = delete;
 
-  void InitLedText(cLEDText& led_text, const int width, const int height,
+  void InitLedText(TextRenderer& led_text, const int width, const int height,
                    const int x, const int y) {
-    led_text.Init(leds_.get(), width, height, x, y);
+    led_text.Init(frame_, width, height, x, y);
   };
 
-  int GetWidth() const { return leds_->Width(); };
+  Framebuffer& frame() { return frame_; };
+  const Framebuffer& front() const { return front_; };
+
+  int GetWidth() const { return frame_.Width(); };
+  int GetHeight() const { return frame_.Height(); };
 
   bool IsEnabled() const { return enable_display_; };
   void Enable() { enable_display_ = true; };
@@ -77,16 +80,32 @@ class DisplayManager {
   void SetBrightness(const uint8_t brightness);
 
   void FillArea(const int x, const int y, const int width, const int height,
-                const CRGB color = CRGB::Black) {
-    leds_->DrawFilledRectangle(x, y, x + width - 1, y + height - 1, color);
+                const Rgb color = kBlack) {
+    frame_.FillArea(x, y, width, height, color);
   };
 
- private:
-  DisplayManager(std::shared_ptr<cLEDMatrixBase> leds, bool enable_display)
-      : leds_(leds), enable_display_(enable_display){};
+  // Blanks the whole frame. If `show` is set, the blank frame is also sent to
+  // the display right away.
+  void Clear(bool show = false);
 
-  std::shared_ptr<cLEDMatrixBase> leds_;
+  // Makes the back buffer the new front buffer, and sends it to the display.
+  // Returns false if there was nothing to send.
+  bool Show();
+
+  // Calls to Show() that had nothing to send. Safe to read from any task.
+  uint32_t skipped_shows() const {
+    return skipped_shows_.load(std::memory_order_relaxed);
+  };
+
+ private:
+  std::unique_ptr<DisplayOutput> output_;
+  Framebuffer frame_, front_;
   bool enable_display_ = true;
+
+  const int sections_;
+  // Brightness and power changes only reach the LEDs when they're shown
+  bool show_all_ = false;
+  std::atomic<uint32_t> skipped_shows_{0};
 };
 
 }  // namespace led_marquee
@@ -0,0 +1,96 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastled_output.h"
+
+#include <FastLED.h>
+#include <assert.h>
+#include <stdint.h>
+
+#include "framebuffer.h"
+#include "rgb.h"
+
+namespace led_marquee {
+
+namespace {
+
+#if defined(ESP32)
+// FastLED's ESP32 (RMT) driver holds each controller's data until every
+// controller has been shown, then sends them all in parallel. Showing only
+// the dirty ones would never send anything, so on the ESP32 every change goes
+// out to all pins. The time on the wire is that of one section either way,
+// since they go in parallel; what's saved here is only the copy of
+// unchanged sections, and unchanged frames, which aren't sent at all (see
+// DisplayManager::Show()). Showing single sections, and the power limit
+// worked out below, are for boards that send one controller at a time.
+constexpr bool kCanShowSingleSections = false;
+#else
+constexpr bool kCanShowSingleSections = true;
+#endif
+
+}  // namespace
+
+void FastLedOutput::Show(const Framebuffer &frame, uint32_t dirty_sections) {
+  assert(frame.size() == static_cast<size_t>(num_pixels()));
+
+  // Sections are contiguous in the framebuffer, and the table is in the same
+  // order, so there's no need to work out coordinates
+  const Rgb *pixels = frame.data();
+  for (int section = 0; section < num_sections_; section++) {
+    if (!(dirty_sections & (1u << section))) continue;
+
+    const int first = section * section_pixels_;
+    for (int i = first; i < first + section_pixels_; i++) {
+      leds_[xy_table_[i]] = CRGB(pixels[i].r, pixels[i].g, pixels[i].b);
+    }
+  }
+
+  const uint32_t all_sections = ~0u >> (kMaxSections - num_sections_);
+  if (!kCanShowSingleSections || dirty_sections == all_sections) {
+    FastLED.show();
+    return;
+  }
+
+  // FastLED.show() would apply the power limit; showing controllers one at a
+  // time means doing it here, over the whole display.
+  uint8_t brightness = FastLED.getBrightness();
+  if (max_milliamps_ > 0) {
+    brightness = calculate_max_brightness_for_power_vmA(
+        leds_.get(), static_cast<uint16_t>(num_pixels()), brightness, volts_,
+        max_milliamps_);
+  }
+  for (int section = 0; section < num_sections_; section++) {
+    if (dirty_sections & (1u << section)) {
+      FastLED[ControllerFor(section)].showLeds(brightness);
+    }
+  }
+}
+
+void FastLedOutput::SetBrightness(uint8_t brightness) {
+  FastLED.setBrightness(brightness);
+}
+
+void FastLedOutput::SetMaxPower(uint8_t volts, uint32_t max_milliamps) {
+  FastLED.setMaxPowerInVoltsAndMilliamps(volts, max_milliamps);
+  volts_ = volts;
+  max_milliamps_ = max_milliamps;
+}
+
+int FastLedOutput::ControllerFor(int section) const {
+  // Sections were registered in order along the LED string, so find where the
+  // section's first pixel is on the string
+  return xy_table_[section * section_pixels_] / section_pixels_;
+}
+
+}  // namespace led_marquee
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_FASTLED_OUTPUT_H_
+#define LED_MARQUEE_FASTLED_OUTPUT_H_
+
+#include <FastLED.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "display_manager.h"
+#include "framebuffer.h"
+#include "led_sections.h"
+
+namespace led_marquee {
+
+// Sends frames to the LEDs with FastLED. `xy_table` maps the framebuffer onto
+// the physical wiring: it has the LED index for each pixel, in the same order
+// as Framebuffer::data() (see XyTable).
+//
+// Only the dirty sections are copied. Only those are sent, too, except on
+// the ESP32, whose driver sends all sections at once (see
+// kCanShowSingleSections).
+class FastLedOutput : public DisplayOutput {
+ public:
+  // Registers one FastLED controller per pin in `pins`, each driving the next
+  // `section_width` columns of the matrix.
+  template <template <uint8_t, EOrder> class chipset, EOrder color_order,
+            uint8_t... pins>
+  static std::unique_ptr<FastLedOutput> Create(PinList<pins...> data_pins,
+                                               int section_width,
+                                               int matrix_height,
+                                               const uint16_t *xy_table) {
+    static_assert(sizeof...(pins) <= kMaxSections, "Too many sections");
+    const int section_pixels = section_width * matrix_height;
+    auto output = std::unique_ptr<FastLedOutput>(
+        new FastLedOutput(xy_table, sizeof...(pins), section_pixels));
+
+    Controllers<chipset, color_order> controllers{output->leds_.get()};
+    AddSections(controllers, data_pins, section_pixels);
+
+    // For safety, start with everything off and brightness turned down
+    FastLED.setBrightness(10);
+    FastLED.clear(true);
+
+    return output;
+  };
+
+  // Not copyable
+  FastLedOutput(const FastLedOutput &other) = delete;
+  FastLedOutput &operator=(const FastLedOutput &other) = delete;
+
+  int Sections() const override { return num_sections_; };
+  void Show(const Framebuffer &frame, uint32_t dirty_sections) override;
+  void SetBrightness(uint8_t brightness) override;
+  void SetMaxPower(uint8_t volts, uint32_t max_milliamps) override;
+
+ private:
+  // Adapts FastLED to AddSections()
+  template <template <uint8_t, EOrder> class chipset, EOrder color_order>
+  struct Controllers {
+    CRGB *leds;
+
+    template <uint8_t pin>
+    void AddSection(int first_pixel, int num_pixels) {
+      FastLED.addLeds<chipset, pin, color_order>(leds + first_pixel,
+                                                 num_pixels);
+    }
+  };
+
+  FastLedOutput(const uint16_t *xy_table, int num_sections, int section_pixels)
+      : leds_(new CRGB[num_sections * section_pixels]),
+        xy_table_(xy_table),
+        num_sections_(num_sections),
+        section_pixels_(section_pixels){};
+
+  int num_pixels() const { return num_sections_ * section_pixels_; };
+
+  // The FastLED controller for a section of the framebuffer. These aren't
+  // necessarily in the same order, e.g. when the data comes in on the right.
+  int ControllerFor(int section) const;
+
+  // In the order they are on the LED strings
+  std::unique_ptr<CRGB[]> leds_;
+  const uint16_t *xy_table_;
+  const int num_sections_;
+  const int section_pixels_;
+  uint8_t volts_ = 0;
+  uint32_t max_milliamps_ = 0;
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_FASTLED_OUTPUT_H_
@@ -0,0 +1,121 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fields.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace led_marquee {
+
+std::string_view Fields::Get(std::string_view spec, uint32_t *version) {
+  auto entry = std::find_if(cache_.begin(), cache_.end(),
+                            [&](const auto &e) { return e.spec == spec; });
+  if (entry == cache_.end()) {
+    if (cache_.size() >= kMaxCached) cache_.erase(cache_.begin());
+    cache_.push_back({std::string(spec), {}, 0, ~0ull});
+    entry = cache_.end() - 1;
+  }
+
+  const auto colon = entry->spec.find(':');
+  const std::string_view name = std::string_view(entry->spec).substr(0, colon);
+  // The spec is NUL terminated, so the argument is too
+  const char *arg =
+      colon == std::string::npos ? "" : entry->spec.c_str() + colon + 1;
+
+  char buf[kMaxValueLength + 1];
+  if (name == "time" || name == "date") {
+    if (!*arg) arg = name == "time" ? "%H:%M" : "%Y-%m-%d";
+    const time_t now = wall_clock_();
+    if (entry->stamp != static_cast<uint64_t>(now)) {
+      tm timeinfo;
+      localtime_r(&now, &timeinfo);
+      const std::size_t len = strftime(buf, sizeof(buf), arg, &timeinfo);
+      Update(*entry, static_cast<uint64_t>(now), std::string_view(buf, len));
+    }
+  } else if (name == "uptime") {
+    const uint32_t seconds = millis_() / 1000;
+    if (entry->stamp != seconds) {
+      const uint32_t days = seconds / 86400;
+      const uint32_t h = seconds / 3600 % 24, m = seconds / 60 % 60;
+      const int len =
+          days > 0 ? snprintf(buf, sizeof(buf), "%ud %02u:%02u",
+                              static_cast<unsigned>(days),
+                              static_cast<unsigned>(h),
+                              static_cast<unsigned>(m))
+                   : snprintf(buf, sizeof(buf), "%02u:%02u:%02u",
+                              static_cast<unsigned>(h),
+                              static_cast<unsigned>(m),
+                              static_cast<unsigned>(seconds % 60));
+      Update(*entry, seconds,
+             std::string_view(buf, std::min<std::size_t>(
+                                       static_cast<std::size_t>(len),
+                                       kMaxValueLength)));
+    }
+  } else if (name == "topic") {
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    for (const auto &topic : topics_) {
+      if (topic.name == arg) {
+        if (entry->stamp != topic.version) {
+          Update(*entry, topic.version, topic.value);
+        }
+        break;
+      }
+    }
+  }
+
+  if (version) *version = entry->version;
+  return entry->value;
+}
+
+void Fields::Update(CacheEntry &entry, uint64_t stamp, std::string_view value) {
+  entry.stamp = stamp;
+  if (entry.value != value) {
+    entry.value.assign(value);
+    entry.version = ++last_version_;
+  }
+}
+
+bool Fields::WatchTopic(std::string_view topic) {
+  if (topic.find_first_of("+#") != std::string_view::npos) return false;
+
+  std::lock_guard<std::mutex> lock(topics_mutex_);
+  if (topics_.size() >= kMaxTopics) return false;
+  for (const auto &t : topics_) {
+    if (t.name == topic) return false;
+  }
+  topics_.push_back({std::string(topic), {}, 0});
+  return true;
+}
+
+bool Fields::SetTopic(std::string_view topic, std::string_view value) {
+  std::lock_guard<std::mutex> lock(topics_mutex_);
+  for (auto &t : topics_) {
+    if (t.name == topic) {
+      t.value.assign(value.substr(0, kMaxValueLength));
+      t.version++;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace led_marquee
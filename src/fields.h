@@ -0,0 +1,105 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_FIELDS_H_
+#define LED_MARQUEE_FIELDS_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace led_marquee {
+
+// Values for the dynamic fields in messages, e.g. `{time:%H:%M}`. The spec
+// of a field is what was between the braces (see Interpolate()).
+//
+// Values are cached, and only worked out again when they could have changed.
+// Get() is for the render task only; the topic functions are safe to call
+// from any task.
+class Fields {
+ public:
+  using WallClock = time_t (*)();
+  using Millis = uint32_t (*)();
+
+  // Topics are kept until reboot, so there's a limit
+  static constexpr std::size_t kMaxTopics = 8;
+  // Longer values are truncated
+  static constexpr std::size_t kMaxValueLength = 64;
+  // Different fields remembered at once
+  static constexpr std::size_t kMaxCached = 16;
+
+  Fields(WallClock wall_clock, Millis millis)
+      : wall_clock_(wall_clock), millis_(millis){};
+
+  // Not copyable
+  Fields(const Fields &) = delete;
+  Fields &operator=(const Fields &) = delete;
+
+  // The current value for `spec`. If `version` is given, it's set to a number
+  // that changes whenever the value does. Versions are never reused, even
+  // for a field that drops out of the cache and comes back. The value is good
+  // until the next call.
+  std::string_view Get(std::string_view spec, uint32_t *version = nullptr);
+
+  // Starts keeping the value of `topic`. Returns false if it already was,
+  // there's no room for it, or it has wildcards (+ or #), which would
+  // subscribe to far more than one value.
+  bool WatchTopic(std::string_view topic);
+  // Records the value of a watched topic. Returns false if it isn't one.
+  bool SetTopic(std::string_view topic, std::string_view value);
+  // Calls `fn` with each watched topic, e.g. to subscribe again
+  template <typename Fn>
+  void ForEachTopic(Fn fn) {
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    for (const auto &topic : topics_) fn(std::string_view(topic.name));
+  }
+
+ private:
+  struct CacheEntry {
+    std::string spec;
+    std::string value;
+    uint32_t version = 0;
+    // Whatever the value was worked out from, e.g. the time in seconds
+    uint64_t stamp = ~0ull;
+  };
+
+  struct Topic {
+    std::string name;
+    std::string value;
+    uint32_t version = 0;
+  };
+
+  // Works out the value into `entry` if the stamp has changed
+  void Update(CacheEntry &entry, uint64_t stamp, std::string_view value);
+
+  WallClock wall_clock_;
+  Millis millis_;
+  std::vector<CacheEntry> cache_;
+  // The last version given to any entry
+  uint32_t last_version_ = 0;
+
+  std::mutex topics_mutex_;
+  std::vector<Topic> topics_;
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_FIELDS_H_
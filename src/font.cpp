@@ -0,0 +1,51 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "font.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+namespace led_marquee {
+
+Font::Font(const uint8_t *font_data) {
+  if (!font_data) return;
+
+  width_ = font_data[0];
+  height_ = font_data[1];
+  first_ = font_data[2];
+  last_ = font_data[3];
+  glyphs_ = &font_data[4];
+  row_bytes_ = (width_ + 7) / 8;
+
+  // Columns are returned as a 32-bit mask
+  assert(height_ <= 32);
+}
+
+uint32_t Font::Column(uint8_t c, int x) const {
+  if (!glyphs_ || c < first_ || c > last_ || x < 0 || x >= width_) return 0;
+
+  const uint8_t *glyph = glyphs_ + (c - first_) * row_bytes_ * height_;
+  const uint8_t *byte = glyph + x / 8;
+  const auto mask = static_cast<uint8_t>(0x80 >> (x % 8));
+
+  uint32_t column = 0;
+  for (int row = 0; row < height_; row++, byte += row_bytes_) {
+    if (*byte & mask) column |= 1u << row;
+  }
+
+  return column;
+}
+
+}  // namespace led_marquee
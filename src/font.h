@@ -0,0 +1,50 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_FONT_H_
+#define LED_MARQUEE_FONT_H_
+
+#include <stdint.h>
+
+namespace led_marquee {
+
+// Read-only view of font data in LEDText's format (e.g. ClassicFontData): a
+// header of width, height, first char and last char, followed by the glyphs.
+// Each glyph is `height` rows from the top down, each row being
+// (width + 7) / 8 bytes with the leftmost pixel in the most significant bit.
+class Font {
+ public:
+  explicit Font(const uint8_t *font_data = nullptr);
+
+  uint8_t Width() const { return width_; };
+  uint8_t Height() const { return height_; };
+
+  // Horizontal space taken by one character, including the gap after it
+  int Advance() const { return width_ + 1; };
+
+  // Pixels of one column of `c` as a bit mask, bit 0 being the top row.
+  // Characters outside the font are blank.
+  uint32_t Column(uint8_t c, int x) const;
+
+ private:
+  const uint8_t *glyphs_ = nullptr;
+  uint8_t width_ = 0, height_ = 0, first_ = 0, last_ = 0;
+  int row_bytes_ = 0;
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_FONT_H_
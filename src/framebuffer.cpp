@@ -0,0 +1,51 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "framebuffer.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+
+#include "rgb.h"
+
+namespace led_marquee {
+
+Framebuffer::Framebuffer(int width, int height)
+    : width_(std::max(width, 0)),
+      height_(std::max(height, 0)),
+      pixels_(static_cast<size_t>(width_) * static_cast<size_t>(height_)) {}
+
+void Framebuffer::Set(int x, int y, Rgb color) {
+  if (Contains(x, y)) At(x, y) = color;
+}
+
+Rgb Framebuffer::Get(int x, int y) const {
+  return Contains(x, y) ? At(x, y) : kBlack;
+}
+
+void Framebuffer::FillArea(int x, int y, int width, int height, Rgb color) {
+  const int x0 = std::max(x, 0);
+  const int y0 = std::max(y, 0);
+  const int x1 = std::min(x + width, width_);
+  const int y1 = std::min(y + height, height_);
+  if (x0 >= x1 || y0 >= y1) return;
+
+  for (int col = x0; col < x1; col++) {
+    Rgb *column = &At(col, 0);
+    std::fill(column + y0, column + y1, color);
+  }
+}
+
+}  // namespace led_marquee
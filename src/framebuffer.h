@@ -0,0 +1,71 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_FRAMEBUFFER_H_
+#define LED_MARQUEE_FRAMEBUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "rgb.h"
+
+namespace led_marquee {
+
+// An in-memory frame, independent of how the pixels are wired up. Like
+// cLEDMatrix, (0, 0) is the bottom-left pixel. Pixels are stored column by
+// column, so a column of the display is contiguous in memory.
+class Framebuffer {
+ public:
+  Framebuffer(int width, int height);
+
+  int Width() const { return width_; };
+  int Height() const { return height_; };
+
+  bool Contains(int x, int y) const {
+    return x >= 0 && x < width_ && y >= 0 && y < height_;
+  };
+
+  // Unchecked access
+  Rgb &At(int x, int y) { return pixels_[Index(x, y)]; };
+  const Rgb &At(int x, int y) const { return pixels_[Index(x, y)]; };
+
+  // Checked access; out of range pixels are ignored or read as black.
+  void Set(int x, int y, Rgb color);
+  Rgb Get(int x, int y) const;
+
+  // Fills a rectangle, clipped to the frame.
+  void FillArea(int x, int y, int width, int height, Rgb color = kBlack);
+  void Clear() { FillArea(0, 0, width_, height_); };
+
+  Rgb *data() { return pixels_.data(); };
+  const Rgb *data() const { return pixels_.data(); };
+  size_t size() const { return pixels_.size(); };
+
+ private:
+  size_t Index(int x, int y) const {
+    return static_cast<size_t>(x) * static_cast<size_t>(height_) +
+           static_cast<size_t>(y);
+  };
+
+  int width_, height_;
+  std::vector<Rgb> pixels_;
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_FRAMEBUFFER_H_
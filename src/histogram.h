@@ -0,0 +1,75 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_HISTOGRAM_H_
+#define LED_MARQUEE_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace led_marquee {
+
+// Counts values by bucket, e.g. how long frames take, for /metrics. Each
+// bucket counts the values up to its bound that weren't in an earlier one;
+// values above the last bound only count toward count() and sum().
+//
+// Recording is a few relaxed atomic adds, so it's cheap enough for the render
+// task, and anyone can read along. A reader may see a value in count() before
+// it's in its bucket.
+template <std::size_t N>
+class Histogram {
+ public:
+  using Bounds = std::array<uint32_t, N>;
+
+  // `bounds` must be in increasing order
+  explicit Histogram(const Bounds &bounds) : bounds_(bounds) {}
+
+  // Not copyable
+  Histogram(const Histogram &) = delete;
+  Histogram &operator=(const Histogram &) = delete;
+
+  void Record(uint32_t value) {
+    const auto bound = std::lower_bound(bounds_.begin(), bounds_.end(), value);
+    if (bound != bounds_.end()) {
+      buckets_[static_cast<std::size_t>(bound - bounds_.begin())].fetch_add(
+          1, std::memory_order_relaxed);
+    }
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  const Bounds &bounds() const { return bounds_; };
+  // Values in bucket `i` alone, i.e. not cumulative
+  uint32_t bucket(std::size_t i) const {
+    return buckets_[i].load(std::memory_order_relaxed);
+  };
+  uint32_t count() const { return count_.load(std::memory_order_relaxed); };
+  uint64_t sum() const { return sum_.load(std::memory_order_relaxed); };
+
+ private:
+  const Bounds bounds_;
+  std::array<std::atomic<uint32_t>, N> buckets_{};
+  std::atomic<uint32_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_HISTOGRAM_H_
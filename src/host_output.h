@@ -0,0 +1,57 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_HOST_OUTPUT_H_
+#define LED_MARQUEE_HOST_OUTPUT_H_
+
+#include <stdint.h>
+
+#include "display_manager.h"
+#include "framebuffer.h"
+
+namespace led_marquee {
+
+// Display output for running the render pipeline without any LEDs attached.
+// Keeps a copy of the last frame shown, so tests can look at it.
+class HostOutput : public DisplayOutput {
+ public:
+  HostOutput(int width, int height, int sections = 1)
+      : shown_(width, height), sections_(sections){};
+
+  int Sections() const override { return sections_; };
+  void Show(const Framebuffer &frame, uint32_t dirty_sections) override {
+    shown_ = frame;
+    dirty_sections_ = dirty_sections;
+    show_count_++;
+  };
+  void SetBrightness(uint8_t brightness) override { brightness_ = brightness; };
+
+  const Framebuffer &shown() const { return shown_; };
+  uint32_t dirty_sections() const { return dirty_sections_; };
+  int show_count() const { return show_count_; };
+  uint8_t brightness() const { return brightness_; };
+
+ private:
+  Framebuffer shown_;
+  const int sections_;
+  uint32_t dirty_sections_ = 0;
+  int show_count_ = 0;
+  uint8_t brightness_ = 0;
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_HOST_OUTPUT_H_
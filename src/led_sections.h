@@ -0,0 +1,46 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_LED_SECTIONS_H_
+#define LED_MARQUEE_LED_SECTIONS_H_
+
+#include <stdint.h>
+
+namespace led_marquee {
+
+// The data pin of each section, in order. FastLED needs pins as template
+// arguments, so keeping them in a parameter pack lets any number of sections
+// be set up without copy and paste or runtime checks.
+template <uint8_t... Pins>
+struct PinList {
+  static_assert(sizeof...(Pins) > 0, "A marquee needs at least one section");
+
+  static constexpr int kCount = sizeof...(Pins);
+};
+
+// Calls `controller.AddSection<pin>(first_pixel, num_pixels)` for each
+// section in order, each one taking the next `section_pixels` LEDs.
+template <typename Controller, uint8_t... Pins>
+void AddSections(Controller &controller, PinList<Pins...>, int section_pixels) {
+  int first_pixel = 0;
+  ((controller.template AddSection<Pins>(first_pixel, section_pixels),
+    first_pixel += section_pixels),
+   ...);
+}
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_LED_SECTIONS_H_
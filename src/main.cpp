@@ -19,58 +19,163 @@
 #include <ArduinoJson.h>
 #include <ArduinoOTA.h>
 #include <AsyncMqttClient.h>
+#include <AsyncUDP.h>
 #include <FS.h>
 #include <FastLED.h>
 #include <FontMatrise.h>
-#include <LEDMatrix.h>
-#include <LEDText.h>
 #include <SPIFFS.h>
 #include <WiFiManager.h>
+#include <esp_timer.h>
 #include <interpolate.h>
+#include <markup.h>
+#include <sys/time.h>
 // Needed to resolve conflict between ArduinoOTA and ESPAsyncWebServer
 #define WEBSERVER_H
 #include <ESPAsyncWebServer.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 extern "C" {
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
 #include "freertos/timers.h"
 }
 
-#include "clock.h"
+#include "asset_manifest.h"
 #include "debug_serial.h"
 #include "display_manager.h"
+#include "fastled_output.h"
+#include "fields.h"
+#include "histogram.h"
 #include "marquee_config.h"
+#include "message_queue.h"
+#include "metrics_writer.h"
+#include "payload_buffer.h"
+#include "pending_controls.h"
+#include "pixel_stream.h"
+#include "preview.h"
+#include "render_command.h"
 #include "text_layout.h"
+#include "text_renderer.h"
 #include "text_scroller.h"
-#include "text_with_clock_layout.h"
+#include "topic_router.h"
+#include "trace.h"
 #include "user_config.h"
+#include "xy_map.h"
+#include "zone_layout.h"
 
 typedef const char *FsLabel;
 const FsLabel kUserFsLabel = "/user";
 const FsLabel kSpiffsFsLabel = "/spiffs";
 const String kConfigFileName = "/config.json";
+// Written by scripts/gzip_www.py, next to the web assets
+const char *const kAssetManifestFileName = "/www.manifest";
+
+using led_marquee::RenderCommand;
+using led_marquee::TraceEvent;
+
+// The render task outranks loop(), which shares its core
+constexpr UBaseType_t kRenderPriority = 3;
+constexpr uint32_t kRenderStackSize = 8192;
+constexpr UBaseType_t kRenderQueueDepth = 16;
+// Longest the render task sleeps, when no zone is due, before checking for
+// commands
+constexpr uint32_t kMaxRenderSleepMs = 50;
+// Longest to wait for the render task to stop, e.g. for an OTA update
+constexpr uint32_t kRenderStopTimeoutMs = 1000;
+
+// Room for a full-length message and the JSON around it
+constexpr size_t kMaxMqttPayload = kMaxMessageLen + 256;
+
+// Streamed frames to hold back, to smooth out uneven arrival
+constexpr int kPixelStreamJitterFrames = 2;
+
+// Most often the ready topic is published, however fast the queue changes
+constexpr uint32_t kReadyIntervalMs = 100;
+
+// How often the live preview is sent to web clients
+constexpr uint32_t kPreviewIntervalMs = 100;
 
 std::shared_ptr<WiFiManager> wm = std::make_shared<WiFiManager>();
 AsyncWebServer server(80);
+AsyncWebSocket ws("/ws");
 AsyncMqttClient mqtt_client;
-CEveryNMillis *scroll_timer;
 TimerHandle_t mqtt_reconnect_timer;
+TaskHandle_t render_task;
+TaskHandle_t loop_task;
+QueueHandle_t render_queue;
+// Given by the render task when it's stopped (see StopRendering())
+SemaphoreHandle_t render_stopped;
 std::unique_ptr<fs::SPIFFSFS> web_fs;
+led_marquee::AssetManifest web_assets;
 std::shared_ptr<led_marquee::DisplayManager> display_manager;
-std::unique_ptr<led_marquee::TextWithClockLayout> layout;
+std::unique_ptr<led_marquee::ZoneLayout> layout;
 
-uint8_t clock_hue = 0;
-unsigned int scroll_speed = 40;
+// Set on the render task; PublishReady() reads it too
+std::atomic<unsigned int> scroll_speed{40};
 bool is_connected = false;
 bool enable_display = true;
-bool enable_clock = kClockWidth > 0;
 bool enable_ota = false;
-bool config_mode = false;
+std::atomic<bool> config_mode = false;
 bool should_save_config = false;
-String scroll_next;
+// Messages waiting to be scrolled, already interpolated, along with how long
+// they'll take
+struct QueuedMessage {
+  std::string text;
+  led_marquee::ScrollTime time;
+};
+led_marquee::MessageQueue<QueuedMessage, kMessageQueueDepth> messages;
+// Total time of everything in `messages`
+std::atomic<int> queued_frames{0};
+std::atomic<int> queued_fixed_ms{0};
+
+// Health, for /metrics (see WriteMetrics()). Times are in microseconds.
+constexpr led_marquee::Histogram<10>::Bounds kTimingBucketsUs = {
+    250, 500, 1000, 2000, 4000, 8000, 16000, 32000, 64000, 128000};
+// Each frame's work, from taking commands to showing it
+led_marquee::Histogram<10> frame_time_us(kTimingBucketsUs);
+// Sending frames to the LEDs, when there was something to send
+led_marquee::Histogram<10> show_time_us(kTimingBucketsUs);
+// Streamed frames that were still being drawn when the next one was due, and
+// zone updates that were missed altogether (see ZoneLayout::late_updates())
+std::atomic<uint32_t> late_frames{0};
+std::atomic<uint32_t> messages_shown{0};
+std::atomic<uint32_t> mqtt_disconnects{0};
+
+// Recent events, for seeing where the time goes (see /trace)
+constexpr std::size_t kTraceRecords = 512;
+led_marquee::TraceRing<kTraceRecords> trace_ring;
+
+// Settings waiting for the next frame, of which only the latest counts
+led_marquee::PendingControls pending_controls;
+
+// Values for {time}, {topic:...} and the like in messages
+led_marquee::Fields fields([]() { return time(nullptr); },
+                           []() -> uint32_t { return millis(); });
+
+// Frames streamed over UDP, which take over the display while they last
+led_marquee::PixelStream pixel_stream(kMarqueeWidth, kPanelHeight,
+                                      kPixelStreamJitterFrames);
+AsyncUDP pixel_udp;
+
+// What's on the display, for web clients connected to /ws. The render task
+// only captures frames while someone's watching.
+led_marquee::Preview preview(kMarqueeWidth, kPanelHeight, kPreviewIntervalMs);
+std::atomic<int> preview_viewers{0};
+// Set when someone new connects, who needs a whole frame to start from
+std::atomic<bool> preview_key_frame{false};
+
+// Incoming MQTT payloads, put back together if they arrived in pieces
+led_marquee::PayloadBuffer<kMaxMqttPayload> mqtt_payload;
 
 String mqtt_node_topic;
 String mqtt_command_topic;
@@ -78,10 +183,150 @@ String mqtt_ready_topic;
 
 led_marquee::UserConfig config(wm);
 
+uint32_t TraceTime() { return static_cast<uint32_t>(esp_timer_get_time()); }
+
+// Records an event in trace_ring. Cheap enough for the render task, and
+// safe from any task.
+void Trace(TraceEvent event, uint32_t arg = 0, uint32_t time_us = TraceTime()) {
+  using led_marquee::TraceThread;
+
+  const TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  TraceThread thread;
+  if (task == render_task) {
+    thread = TraceThread::kRender;
+  } else if (task == loop_task) {
+    thread = TraceThread::kLoop;
+  } else {
+    thread = xPortGetCoreID() == 0 ? TraceThread::kCore0 : TraceThread::kCore1;
+  }
+  trace_ring.Record(time_us, event, thread, arg);
+}
+
+// Sends the frame to the LEDs, timing it if there was anything to send
+void ShowFrame() {
+  Trace(TraceEvent::kShowBegin);
+  const int64_t start = esp_timer_get_time();
+  if (display_manager->Show()) {
+    show_time_us.Record(static_cast<uint32_t>(esp_timer_get_time() - start));
+  }
+  Trace(TraceEvent::kShowEnd);
+}
+
+// Shows static text right away, for when the render task isn't running:
+// before it starts, or once it's stopped
+void ShowStaticTextNow(led_marquee::TextScroller &text,
+                       std::string_view message) {
+  text.ShowStaticText(message);
+  ShowFrame();
+}
+
+// The display pipeline doesn't know about Arduino strings
+std::string_view AsView(const String &str) {
+  return std::string_view(str.c_str(), str.length());
+}
+
+// Queue a message to scroll after the current one. Safe to call from any
+// task.
+void QueueMessage(std::string_view text) {
+  const auto time = layout->text().Estimate(text);
+
+  // Counted first, so that the total never goes negative if it's shown
+  // right away
+  queued_frames += time.frames;
+  queued_fixed_ms += time.fixed_ms;
+  if (!messages.Push({std::string(text), time})) {
+    queued_frames -= time.frames;
+    queued_fixed_ms -= time.fixed_ms;
+    debug_println("Message queue full, dropping message");
+    return;
+  }
+  Trace(TraceEvent::kQueueDepth, static_cast<uint32_t>(messages.Size()));
+}
+
+// Take the next message to show off the queue, if there is one
+bool PopMessage(QueuedMessage &message) {
+  if (!messages.Pop(message)) return false;
+
+  messages_shown++;
+  Trace(TraceEvent::kMessage, static_cast<uint32_t>(message.text.size()));
+  Trace(TraceEvent::kQueueDepth, static_cast<uint32_t>(messages.Size()));
+  queued_frames -= message.time.frames;
+  queued_fixed_ms -= message.time.fixed_ms;
+  return true;
+}
+
+// Wall clock time in milliseconds, for timestamps that mean something to
+// clients
+int64_t EpochMs() {
+  timeval now;
+  gettimeofday(&now, nullptr);
+  return static_cast<int64_t>(now.tv_sec) * 1000 + now.tv_usec / 1000;
+}
+
+// The scroller's state for the ready topic, as of the last NoteReady(): are
+// we waiting for something to show, and how long the current message had
+// left, as of when
+std::atomic<bool> scroller_ready{false};
+std::atomic<int> ready_eta_ms{0};
+std::atomic<uint32_t> ready_eta_at{0};
+// Set when there's news for loop() to publish
+std::atomic<bool> ready_changed{false};
+
+// Records the scroller's state for PublishReady(). Runs on the render task,
+// which leaves talking to the network to loop().
+void NoteReady(bool ready) {
+  ready_eta_ms = ready ? 0 : layout->text().RemainingMs();
+  ready_eta_at = millis();
+  scroller_ready = ready;
+  ready_changed = true;
+}
+
+// Tell clients whether we're waiting for something to show, and how much is
+// already lined up. Clients can keep up to `credits` messages in flight, and
+// have the next one queued before `eta_ms` is up, rather than waiting for
+// `ready`. Called from loop(), which publishes when the render task has
+// noted a change, or the queue depth has changed (e.g. a client's message
+// was taken), but no more often than every kReadyIntervalMs.
+//
+// The timestamps are in milliseconds since the epoch: `finish_at` is when
+// the current message will be done, and `next_start_at` is when a message
+// sent now would start, after everything that's queued.
+void PublishReady() {
+  static size_t published_depth = 0;
+  static uint32_t last_publish = 0;
+
+  const size_t depth = messages.Size();
+  if (!ready_changed && depth == published_depth) return;
+  if (millis() - last_publish < kReadyIntervalMs) return;
+  last_publish = millis();
+  published_depth = depth;
+  // Cleared before reading, so that a change from here on isn't lost
+  ready_changed = false;
+
+  const bool ready = scroller_ready;
+  const int eta_ms = std::max(
+      ready_eta_ms - static_cast<int>(millis() - ready_eta_at), 0);
+  const led_marquee::ScrollTime queued{queued_frames, queued_fixed_ms};
+  const int64_t finish_at = EpochMs() + eta_ms;
+  const int64_t next_start_at =
+      finish_at + queued.Ms(static_cast<int>(scroll_speed));
+
+  char payload[192];
+  snprintf(payload, sizeof(payload),
+           "{\"ready\": %s, \"queue_depth\": %u, \"credits\": %u, "
+           "\"eta_ms\": %d, \"finish_at\": %lld, \"next_start_at\": %lld}",
+           ready ? "true" : "false", static_cast<unsigned>(depth),
+           static_cast<unsigned>(messages.capacity() - depth),
+           eta_ms, static_cast<long long>(finish_at),
+           static_cast<long long>(next_start_at));
+  mqtt_client.publish(mqtt_ready_topic.c_str(), 0, false, payload);
+}
+
 // Process one tick of the animation loop
 void AnimateScroller() {
   static bool scroll_wait = false;
   static unsigned long wait_start;
+  static QueuedMessage next_message;
 
   if (!scroll_wait) {
     if (!layout->text().Animate()) {
@@ -91,51 +336,78 @@ void AnimateScroller() {
         layout->text().ShowScrollText();
       }
       // Is there a new message queued?
-      else if (!scroll_next.isEmpty()) {
+      else if (PopMessage(next_message)) {
         // Something's queued up. Show it.
-        layout->text().ShowScrollText(scroll_next);
-        // Clear the queue
-        scroll_next.clear();
+        layout->text().ShowScrollText(next_message.text);
         // Allow clients to queue ahead and avoid the time delay.
-        mqtt_client.publish(mqtt_ready_topic.c_str(), 0, false,
-                            "{\"ready\": false}");
+        NoteReady(false);
       } else {
         // Nothing queued. Notify and wait for a new message to come in.
         scroll_wait = true;
-        mqtt_client.publish(mqtt_ready_topic.c_str(), 0, false,
-                            "{\"ready\": true}");
+        NoteReady(true);
         wait_start = millis();
       }
     }
-  } else {
-    // We're in the waiting period. See if it's up.
-    unsigned long m = millis();
-    if (m - wait_start > kSmWaitTime) {
-      // Yes, it is. Resuming scrolling, with a new message if we have one.
-      scroll_wait = false;
-      if (!scroll_next.isEmpty()) {
-        // Something's queued up
-        layout->text().ShowScrollText(scroll_next);
-        // Clear the queue
-        scroll_next.clear();
-      } else {
-        // Restart the existing message.
-        layout->text().ShowScrollText();
-      }
-      // Allow clients to queue ahead and avoid the time delay.
-      mqtt_client.publish(mqtt_ready_topic.c_str(), 0, false,
-                          "{\"ready\": false}");
-    }
+  } else if (PopMessage(next_message)) {
+    // A new message doesn't have to wait out the pause
+    scroll_wait = false;
+    layout->text().ShowScrollText(next_message.text);
+    NoteReady(false);
+  } else if (millis() - wait_start > kSmWaitTime) {
+    // Nothing new came in while waiting. Restart the existing message.
+    scroll_wait = false;
+    layout->text().ShowScrollText();
+    // Allow clients to queue ahead and avoid the time delay.
+    NoteReady(false);
   }
 }
 
-// Resets the layout to use the full display for text. This is intended for
-// things like entering configuration mode: there is no returning to normal
-// without rebooting.
-void RemoveClock() {
-  enable_clock = false;
-  layout = std::make_unique<led_marquee::TextWithClockLayout>(
-      *display_manager, kTextFont, 0, kClockFont);
+// Frees what a command owns, when it isn't going to be carried out
+void DiscardCommand(const RenderCommand &command) {
+  delete command.text;
+  if (command.batch) {
+    for (const auto &c : *command.batch) DiscardCommand(c);
+    delete command.batch;
+  }
+}
+
+// Hand a command to the render task. Must not be called from the render task
+// itself, and gives up rather than wait if the queue is full.
+void PostCommand(RenderCommand command) {
+  if (xQueueSend(render_queue, &command, 0) != pdTRUE) {
+    debug_println("Render queue full, dropping command");
+    DiscardCommand(command);
+  }
+}
+
+// Change a setting. Unlike PostCommand(), only the latest value before the
+// next frame is applied, so it's fine to call as fast as changes come in.
+void SetControl(RenderCommand::Type type, uint32_t value) {
+  pending_controls.Set(type, value);
+}
+
+// Change several settings, all on the same frame
+void SetControls(const std::vector<RenderCommand> &commands) {
+  if (commands.empty()) return;
+  pending_controls.Set(commands.data(), commands.size());
+}
+
+// Hand over several commands, to be carried out together between frames.
+// Controls among them count as set now, so a SetControl() after this still
+// wins over them, and one before doesn't.
+void PostCommands(std::vector<RenderCommand> commands) {
+  if (commands.empty()) return;
+  auto *batch = new std::vector<RenderCommand>(std::move(commands));
+  PostCommand(RenderCommand{RenderCommand::Type::kBatch,
+                            pending_controls.Stamp(), nullptr, batch});
+}
+
+void PostCommand(RenderCommand::Type type, uint32_t value) {
+  PostCommand(RenderCommand{type, value});
+}
+
+void PostCommand(RenderCommand::Type type, std::string_view text) {
+  PostCommand(RenderCommand{type, 0, new std::string(text)});
 }
 
 // Mount a SPIFFS filesystem
@@ -170,23 +442,23 @@ void CheckForResetConfig() {
     delay(50);
     if (digitalRead(kResetPin) == LOW) {
       // "CLEAR?" is too long for one panel :-(
-      layout->text().ShowStaticText("CLR?");
+      ShowStaticTextNow(layout->text(), "CLR?");
       delay(1000);
 
       if (digitalRead(kResetPin) != LOW) return;
-      layout->text().ShowStaticText("CLR?3");
+      ShowStaticTextNow(layout->text(), "CLR?3");
       delay(1000);
 
       if (digitalRead(kResetPin) != LOW) return;
-      layout->text().ShowStaticText("CLR?2");
+      ShowStaticTextNow(layout->text(), "CLR?2");
       delay(1000);
 
       if (digitalRead(kResetPin) != LOW) return;
-      layout->text().ShowStaticText("CLR?1");
+      ShowStaticTextNow(layout->text(), "CLR?1");
       delay(1000);
 
       if (digitalRead(kResetPin) == LOW) {
-        layout->text().ShowStaticText("CLR!");
+        ShowStaticTextNow(layout->text(), "CLR!");
         debug_println("Clearing settings");
         // Reset WiFiManager config
         wm->resetSettings();
@@ -213,10 +485,10 @@ void SaveParamsCallback() {
 // When WiFiManager enters configuration mode, display a prompt
 void ConfigModeCallback(WiFiManager *myWiFiManager) {
   config_mode = true;
-  RemoveClock();
 
-  layout->text().ShowScrollText(
-      "Connect to " + myWiFiManager->getConfigPortalSSID() + " to configure.");
+  PostCommand(RenderCommand::Type::kConfigMode,
+              AsView("Connect to " + myWiFiManager->getConfigPortalSSID() +
+                     " to configure."));
 }
 
 // The exit in the config portal isn't particularly useful, and results in an
@@ -279,25 +551,226 @@ void SetupWiFiManager() {
   wm->setConfigPortalTimeout(300);
 }
 
-void SetClockColor() { layout->clock().SetColorHsv(clock_hue, 0xff, 0xff); }
-
 void InitLEDs() {
-  display_manager =
-      led_marquee::DisplayManager::Create<CHIPSET, kLedPins, kColorOrder>(
-          kMarqueeSections, kSectionWidth, kPanelHeight,
-          std::make_shared<
-              cLEDMatrix<(kReverseDirection ? -kMarqueeWidth : kMarqueeWidth),
-                         kPanelHeight, kMatrixType>>(),
-          true);
+  display_manager = std::make_shared<led_marquee::DisplayManager>(
+      led_marquee::FastLedOutput::Create<CHIPSET, kColorOrder>(
+          LedPins{}, kSectionWidth, kPanelHeight,
+          led_marquee::XyTable<kMatrixType, kMarqueeWidth, kPanelHeight,
+                               kReverseDirection>::kIndex.data()),
+      kMarqueeWidth, kPanelHeight, true);
 
   display_manager->SetMaxPower(kLedVolts, 1000.0 * kLedMaxAmps);
   display_manager->SetBrightness(15);
 
-  layout = std::make_unique<led_marquee::TextWithClockLayout>(
-      *display_manager, kTextFont, kClockWidth, kClockFont);
+  layout = std::make_unique<led_marquee::ZoneLayout>(
+      *display_manager, kZones, std::size(kZones), kTextFont, &fields,
+      []() { return time(nullptr); });
 
   layout->text().SetMaxLength(kMaxMessageLen);
-  SetClockColor();
+  layout->text().SetSpeed(static_cast<int>(scroll_speed));
+  layout->scroller().SetAnimator(
+      [](led_marquee::TextScroller &) { AnimateScroller(); });
+}
+
+// Set by a kStop command, for the render task to stop after the commands
+bool stop_rendering = false;
+// Set when a command has drawn static text, which isn't a zone update, for
+// RenderFrame() to show it
+bool static_text_drawn = false;
+
+// Carry out a command from another task. Runs on the render task, between
+// frames.
+void ApplyCommand(const RenderCommand &command) {
+  Trace(TraceEvent::kCommand, static_cast<uint32_t>(command.type));
+  std::unique_ptr<std::string> text(command.text);
+  std::unique_ptr<std::vector<RenderCommand>> batch(command.batch);
+
+  switch (command.type) {
+    case RenderCommand::Type::kScrollText:
+      layout->text().ShowScrollText(*text);
+      break;
+    case RenderCommand::Type::kStaticText:
+      layout->text().ShowStaticText(*text);
+      static_text_drawn = true;
+      break;
+    case RenderCommand::Type::kTextColor:
+      layout->text().SetColorRgb(static_cast<uint8_t>(command.value >> 16),
+                                 static_cast<uint8_t>(command.value >> 8),
+                                 static_cast<uint8_t>(command.value));
+      break;
+    case RenderCommand::Type::kBrightness:
+      display_manager->SetBrightness(static_cast<uint8_t>(command.value));
+      break;
+    case RenderCommand::Type::kSpeed:
+      if (command.value > 0) {
+        scroll_speed = command.value;
+        layout->text().SetSpeed(static_cast<int>(scroll_speed));
+      }
+      break;
+    case RenderCommand::Type::kEnable:
+      enable_display = command.value != 0;
+      // It was blanked, so everything needs drawing again
+      if (enable_display) layout->Redraw();
+      break;
+    case RenderCommand::Type::kConfigMode:
+      layout->FullScreen();
+      layout->text().ShowScrollText(*text);
+      break;
+    case RenderCommand::Type::kZoneText:
+    case RenderCommand::Type::kZoneValue: {
+      const uint32_t index = command.value >> 24;
+      auto *zone = layout->zone(index);
+      if (!zone) break;
+      if (text) {
+        zone->SetText(*text);
+      } else {
+        // Sign extended from 24 bits
+        zone->SetValue(static_cast<int32_t>(command.value << 8) >> 8);
+      }
+      break;
+    }
+    case RenderCommand::Type::kStop:
+      stop_rendering = true;
+      break;
+    case RenderCommand::Type::kBatch:
+      // `value` is the batch's epoch, to skip controls set since
+      for (const auto &c : *batch) {
+        if (led_marquee::PendingControls::IsControl(c.type) &&
+            !pending_controls.Supersede(c.type, command.value)) {
+          continue;
+        }
+        ApplyCommand(c);
+      }
+      break;
+  }
+}
+
+// Draw and show whatever zones are due. The scroller keeps up with the time
+// at the scroll speed, even if frames are late; the DisplayManager only sends
+// the sections that changed.
+void RenderFrame() {
+  const bool drawn = static_text_drawn;
+  static_text_drawn = false;
+  if (!enable_display) {
+    display_manager->Clear(true);
+    return;
+  }
+
+  // A newly queued message takes over from static text
+  if (!layout->text().IsScrolling() && !messages.Empty()) {
+    layout->text().EnableScrolling();
+  }
+
+  if (layout->Update(millis()) || drawn) ShowFrame();
+}
+
+// Show the next streamed frame, if there's a stream. Returns false when there
+// isn't, and the text is showing.
+bool RenderStreamFrame() {
+  static bool streaming = false;
+
+  if (!enable_display || !pixel_stream.Active(millis())) {
+    if (streaming) {
+      // Back to the text, which the stream drew over
+      streaming = false;
+      display_manager->Clear();
+      layout->Redraw();
+    }
+    return false;
+  }
+
+  streaming = true;
+  if (pixel_stream.NextFrame(display_manager->frame())) {
+    Trace(TraceEvent::kStreamFrame);
+    ShowFrame();
+  }
+  return true;
+}
+
+// Hands what's on the display to the preview, if anyone's watching
+void CapturePreview() {
+  if (preview_viewers > 0) preview.Capture(display_manager->front(), millis());
+}
+
+// Owns the layout and the display from here on. Takes commands between
+// frames, so nothing the network does can hold up a frame.
+void RenderTask(void *) {
+  TickType_t last_wake = xTaskGetTickCount();
+
+  for (;;) {
+    const int64_t start = esp_timer_get_time();
+    Trace(TraceEvent::kFrameBegin);
+
+    // Controls first, so that text queued after them is drawn with them. A
+    // batch carries its own settings along with its text, so they're drawn
+    // together whenever it comes in.
+    pending_controls.TakeAll(ApplyCommand);
+    RenderCommand command;
+    while (xQueueReceive(render_queue, &command, 0) == pdTRUE) {
+      ApplyCommand(command);
+    }
+
+    if (stop_rendering) {
+      // Between frames, so it isn't holding anything anyone else needs
+      xSemaphoreGive(render_stopped);
+      vTaskSuspend(nullptr);
+    }
+
+    if (RenderStreamFrame()) {
+      CapturePreview();
+      Trace(TraceEvent::kFrameEnd);
+      frame_time_us.Record(
+          static_cast<uint32_t>(esp_timer_get_time() - start));
+
+      // As fast as the frames are being sent
+      const TickType_t frame_ticks =
+          pdMS_TO_TICKS(pixel_stream.FrameInterval());
+      const TickType_t elapsed = xTaskGetTickCount() - last_wake;
+      if (elapsed >= frame_ticks) {
+        late_frames++;
+        Trace(TraceEvent::kLateStreamFrame, elapsed - frame_ticks);
+      }
+      vTaskDelayUntil(&last_wake, frame_ticks);
+      continue;
+    }
+
+    // Each zone keeps its own deadline, and counts its own missed updates
+    const uint32_t late_before = layout->late_updates();
+    RenderFrame();
+    CapturePreview();
+    Trace(TraceEvent::kFrameEnd);
+    frame_time_us.Record(static_cast<uint32_t>(esp_timer_get_time() - start));
+    if (const uint32_t late = layout->late_updates() - late_before) {
+      late_frames += late;
+      Trace(TraceEvent::kLateZones, late);
+    }
+
+    // Sleep until the next zone is due. Commands that change a zone are
+    // picked up by then too; nothing waits longer than kMaxRenderSleepMs.
+    const uint32_t sleep_ms =
+        enable_display
+            ? std::min(layout->MsUntilDue(millis()), kMaxRenderSleepMs)
+            : kMaxRenderSleepMs;
+    vTaskDelay(std::max<TickType_t>(pdMS_TO_TICKS(sleep_ms), 1));
+    last_wake = xTaskGetTickCount();
+  }
+}
+
+void StartRenderTask() {
+  render_queue = xQueueCreate(kRenderQueueDepth, sizeof(RenderCommand));
+  render_stopped = xSemaphoreCreateBinary();
+  xTaskCreatePinnedToCore(RenderTask, "render", kRenderStackSize, nullptr,
+                          kRenderPriority, &render_task, kRenderCore);
+}
+
+// Has the render task stop at the end of a frame, for good, so that the
+// caller can draw instead. Returns false if it didn't stop in time, and still
+// has the display.
+bool StopRendering() {
+  const RenderCommand command{RenderCommand::Type::kStop};
+  const TickType_t timeout = pdMS_TO_TICKS(kRenderStopTimeoutMs);
+  return xQueueSend(render_queue, &command, timeout) == pdTRUE &&
+         xSemaphoreTake(render_stopped, timeout) == pdTRUE;
 }
 
 // Save config to filesystem. And then reboot to ensure clean initialization.
@@ -396,6 +869,193 @@ void MqttDiscovery() {
   debug_println();
 }
 
+// Subscribe to the topics of any {topic:...} fields in a compiled message
+void WatchFieldTopics(std::string_view text) {
+  namespace markup = led_marquee::markup;
+  constexpr std::string_view kTopicField = "topic:";
+
+  for (std::size_t i = 0; i < text.size();) {
+    if (!markup::IsOp(text[i])) {
+      i++;
+      continue;
+    }
+    const std::size_t size = markup::OpSize(text.substr(i));
+    if (size == 0) break;
+
+    const auto spec = text.substr(i + 2, size - 2);
+    const bool is_topic = spec.substr(0, kTopicField.size()) == kTopicField;
+    if (text[i] == markup::kField && is_topic) {
+      const auto topic = spec.substr(kTopicField.size());
+      if (fields.WatchTopic(topic) && mqtt_client.connected()) {
+        mqtt_client.subscribe(std::string(topic).c_str(), 0);
+      }
+    }
+    i += size;
+  }
+}
+
+// Subscribe to the topics of any {topic:...} fields in the zones' own text
+void WatchZoneTopics() {
+  for (std::size_t i = 0; i < std::size(kZones); i++) {
+    if (const auto *zone = layout->zone(i)) WatchFieldTopics(zone->Text());
+  }
+}
+
+// Home Assistant-style commands
+void HandleMqttCommand(JsonDocument &json) {
+  if (json.containsKey("state")) {
+    SetControl(RenderCommand::Type::kEnable,
+               json["state"].as<String>() == "ON");
+  }
+  if (json.containsKey("brightness")) {
+    SetControl(RenderCommand::Type::kBrightness,
+               json["brightness"].as<uint8_t>());
+  }
+  if (json.containsKey("color")) {
+    SetControl(RenderCommand::Type::kTextColor,
+               json["color"]["r"].as<uint8_t>() << 16 |
+                   json["color"]["g"].as<uint8_t>() << 8 |
+                   json["color"]["b"].as<uint8_t>());
+  }
+}
+
+// Interpolates a message into scratch space, so that the only allocation is
+// the copy that gets queued. It's good until the next call; MQTT and web
+// callbacks all run on the same task.
+std::string_view InterpolateMessage(std::string_view message) {
+  static char text_buf[kMaxMessageLen];
+  std::string_view text(text_buf, led_marquee::Interpolate(message, text_buf,
+                                                           sizeof(text_buf)));
+  if (text.size() > sizeof(text_buf)) {
+    // Too long, so cut it off, but not partway through an op
+    text = std::string_view(text_buf, led_marquee::markup::CompleteLength(
+                                          {text_buf, sizeof(text_buf)}));
+  }
+  WatchFieldTopics(text);
+  return text;
+}
+
+void HandleMqttText(JsonDocument &json) {
+  if (!json.containsKey("text")) {
+    debug_println("missing key 'text'");
+    return;
+  }
+
+  const std::string_view text = InterpolateMessage(json["text"]);
+  if (json.containsKey("scroll") && json["scroll"] == false) {
+    PostCommand(RenderCommand::Type::kStaticText, text);
+  } else {
+    QueueMessage(text);
+  }
+}
+
+// Display settings, as in a /display or /batch payload
+void AddDisplayCommands(JsonObjectConst json,
+                        std::vector<RenderCommand> &commands) {
+  if (json.containsKey("enabled")) {
+    commands.push_back(
+        {RenderCommand::Type::kEnable, json["enabled"].as<bool>()});
+  }
+  if (json.containsKey("brightness")) {
+    commands.push_back(
+        {RenderCommand::Type::kBrightness, json["brightness"].as<uint8_t>()});
+  }
+  if (json.containsKey("speed")) {
+    commands.push_back(
+        {RenderCommand::Type::kSpeed, json["speed"].as<unsigned int>()});
+  }
+  if (json.containsKey("color")) {
+    String rgb = json["color"];
+    unsigned long rgbl = strtoul(rgb.c_str(), NULL, 16);
+    commands.push_back({RenderCommand::Type::kTextColor,
+                        static_cast<uint32_t>(rgbl & 0xffffff)});
+  }
+}
+
+void HandleMqttDisplay(JsonDocument &json) {
+  std::vector<RenderCommand> commands;
+  AddDisplayCommands(json.as<JsonObjectConst>(), commands);
+  SetControls(commands);
+}
+
+// An array of operations, each with display settings and/or text to show
+// right away, e.g. [{"color": "ff0000", "speed": 30}, {"text": "Hi"}]. They
+// all take effect on the same frame. Settings come first, so that the text
+// is drawn with them; see PostCommands() for how they're ordered against
+// other changes to the same controls.
+void HandleMqttBatch(JsonDocument &json) {
+  constexpr size_t kMaxBatchOps = 16;
+
+  std::vector<RenderCommand> commands, texts;
+  size_t ops = 0;
+  for (JsonObjectConst op : json.as<JsonArrayConst>()) {
+    if (ops++ == kMaxBatchOps) {
+      debug_println("Batch too long, ignoring the rest");
+      break;
+    }
+
+    AddDisplayCommands(op, commands);
+    if (op.containsKey("text")) {
+      const auto type = op["scroll"] == false
+                            ? RenderCommand::Type::kStaticText
+                            : RenderCommand::Type::kScrollText;
+      texts.push_back(
+          {type, 0, new std::string(InterpolateMessage(op["text"]))});
+    }
+  }
+
+  commands.insert(commands.end(), texts.begin(), texts.end());
+  PostCommands(std::move(commands));
+}
+
+// Content for one of the kZones, e.g. {"zone": 2, "text": "{icon:up} 21C"}
+// for a text zone, or {"zone": 3, "value": 75} for a bar
+void HandleMqttZone(JsonDocument &json) {
+  const int index = json["zone"] | -1;
+  if (index < 0 || index >= static_cast<int>(std::size(kZones))) {
+    debug_println("missing or unknown 'zone'");
+    return;
+  }
+
+  const uint32_t zone = static_cast<uint32_t>(index) << 24;
+  if (json.containsKey("text")) {
+    const std::string_view text = InterpolateMessage(json["text"]);
+    PostCommand(RenderCommand{RenderCommand::Type::kZoneText, zone,
+                              new std::string(text)});
+  }
+  if (json.containsKey("value")) {
+    const int value = json["value"];
+    PostCommand(RenderCommand::Type::kZoneValue,
+                zone | (static_cast<uint32_t>(value) & 0xffffff));
+  }
+}
+
+void HandleMqttOta(JsonDocument &json) {
+  if (json.containsKey("enabled")) {
+    enable_ota = json["enabled"];
+  }
+}
+
+// Handlers for the node's own topics, under <prefix>/<node name>. The ones
+// without a handler are our own messages, which are ignored.
+using MqttHandler = void (*)(JsonDocument &json);
+struct MqttRoute {
+  const char *suffix;
+  MqttHandler handler;
+};
+constexpr MqttRoute kMqttRoutes[] = {
+    {"/set", HandleMqttCommand},
+    {"/text", HandleMqttText},
+    {"/display", HandleMqttDisplay},
+    {"/batch", HandleMqttBatch},
+    {"/zone", HandleMqttZone},
+    {"/ota", HandleMqttOta},
+    {"/ready", nullptr},
+    {"/metrics", nullptr},
+};
+// Set up when connecting
+led_marquee::TopicRouter<MqttHandler, std::size(kMqttRoutes)> mqtt_routes;
+
 void OnMqttConnect(bool sessionPresent) {
   debug_println("Connected to MQTT");
 
@@ -403,80 +1063,68 @@ void OnMqttConnect(bool sessionPresent) {
   mqtt_command_topic = mqtt_node_topic + "/set";
   mqtt_ready_topic = mqtt_node_topic + "/ready";
 
+  const std::string_view node_topic = AsView(mqtt_node_topic);
+  mqtt_routes.Clear();
+  for (const auto &route : kMqttRoutes) {
+    if (!mqtt_routes.Add(node_topic, route.suffix, route.handler)) {
+      debug_printf("No room for MQTT route %s\n", route.suffix);
+    }
+  }
+
   String mqtt_subscription = mqtt_node_topic + "/#";
   mqtt_client.subscribe(mqtt_subscription.c_str(), 0);
   debug_println("Subscribed to " + mqtt_subscription);
 
+  fields.ForEachTopic([](std::string_view topic) {
+    mqtt_client.subscribe(std::string(topic).c_str(), 0);
+  });
+
   MqttDiscovery();
 }
 
 void OnMqttMessage(char *topic, char *payload,
                    AsyncMqttClientMessageProperties properties, size_t len,
                    size_t index, size_t total) {
-  String str_topic = String(topic);
-
-  DynamicJsonDocument json(1024);
-  auto deserialize_error = deserializeJson(json, payload);
-  if (!deserialize_error) {
-    if (str_topic == mqtt_command_topic) {
-      // Home Assistant-style commands
-      if (json.containsKey("state")) {
-        enable_display = json["state"].as<String>() == "ON";
-      }
-      if (json.containsKey("brightness")) {
-        display_manager->SetBrightness(json["brightness"]);
-      }
-      if (json.containsKey("color")) {
-        layout->text().SetColorRgb(json["color"]["r"], json["color"]["g"],
-                                   json["color"]["b"]);
-      }
-    } else if (str_topic == mqtt_node_topic + "/text") {
-      if (json.containsKey("text")) {
-        const std::string text = led_marquee::Interpolate(json["text"]);
-        const String str(text.data(), text.length());
-        if (json.containsKey("scroll") && json["scroll"] == false) {
-          layout->text().ShowStaticText(str);
-        } else {
-          scroll_next = str;
-          layout->text().EnableScrolling();
-        }
-      } else {
-        debug_println("missing key 'text'");
-      }
-    } else if (str_topic == mqtt_node_topic + "/display") {
-      if (json.containsKey("enabled")) {
-        enable_display = json["enabled"];
-      }
-      if (json.containsKey("speed")) {
-        scroll_speed = json["speed"];
-        scroll_timer->setPeriod(scroll_speed);
-      }
-      if (json.containsKey("color")) {
-        String rgb = json["color"];
-        unsigned long rgbl = strtoul(rgb.c_str(), NULL, 16);
-        uint8_t b = rgbl & 0xff;
-        uint8_t g = (rgbl >> 8) & 0xff;
-        uint8_t r = (rgbl >> 16) & 0xff;
-        layout->text().SetColorRgb(r, g, b);
-      }
-    } else if (str_topic == mqtt_node_topic + "/ota") {
-      if (json.containsKey("enabled")) {
-        enable_ota = json["enabled"];
-      }
-    } else if (str_topic == mqtt_node_topic + "/ready") {
-      // Ignore our own messages
-    } else {
-      debug_print("Unknown topic: ");
-      debug_println(topic);
+  // Our own messages, which can be larger than the buffer
+  const auto *handler = mqtt_routes.Find(topic);
+  if (handler && !*handler) return;
+
+  if (!mqtt_payload.Add(payload, len, index, total)) {
+    if (index == 0 && total > mqtt_payload.capacity()) {
+      debug_printf("MQTT payload too large (%u bytes), dropping\n",
+                   static_cast<unsigned>(total));
     }
-  } else {
+    return;
+  }
+  const std::string_view message = mqtt_payload.payload();
+  Trace(TraceEvent::kMqttMessage, static_cast<uint32_t>(message.size()));
+
+  // Topics shown in fields are plain text, not JSON
+  if (fields.SetTopic(topic, message)) return;
+
+  if (!handler) {
+    debug_print("Unknown topic: ");
+    debug_println(topic);
+    return;
+  }
+
+  // MQTT callbacks all run on the same task, and are done with the document
+  // before the next message, so one will do
+  static JsonDocument json;
+  auto deserialize_error =
+      deserializeJson(json, message.data(), message.size());
+  if (deserialize_error) {
     debug_print("failed to parse json payload: ");
     debug_println(deserialize_error.c_str());
+    return;
   }
+
+  (*handler)(json);
 }
 
 void OnMqttDisconnect(AsyncMqttClientDisconnectReason reason) {
   debug_println("Disconnected from MQTT.");
+  mqtt_disconnects++;
 
   xTimerStart(mqtt_reconnect_timer, 0);
 }
@@ -506,15 +1154,241 @@ void InitMqtt() {
 
 void InitTime() { configTzTime(kTimeZone, kNtpServer); }
 
+// Everything worth watching on a sign that runs unattended, in the
+// Prometheus text format. Safe to call from any task.
+std::string WriteMetrics() {
+  led_marquee::MetricsWriter metrics;
+
+  metrics.AddHistogram("marquee_frame_seconds",
+                       "Time taken to apply commands, draw and show a frame.",
+                       frame_time_us, 1e-6);
+  metrics.AddHistogram("marquee_led_show_seconds",
+                       "Time taken to send a frame to the LEDs.", show_time_us,
+                       1e-6);
+  metrics.AddCounter("marquee_late_frames_total",
+                     "Frames or zone updates missed by running behind.",
+                     late_frames);
+  metrics.AddCounter("marquee_skipped_shows_total",
+                     "Frames with nothing new to send to the LEDs.",
+                     display_manager->skipped_shows());
+
+  metrics.AddGauge("marquee_message_queue_depth", "Messages waiting to scroll.",
+                   static_cast<double>(messages.Size()));
+  metrics.AddCounter("marquee_messages_shown_total",
+                     "Messages taken off the queue and scrolled.",
+                     messages_shown);
+  metrics.AddCounter("marquee_messages_dropped_total",
+                     "Messages dropped because the queue was full.",
+                     messages.dropped());
+  metrics.AddCounter("marquee_control_updates_total",
+                     "Display settings changed by MQTT or the web.",
+                     pending_controls.updates());
+  metrics.AddCounter("marquee_control_updates_coalesced_total",
+                     "Settings replaced before they took effect.",
+                     pending_controls.coalesced());
+
+  metrics.AddCounter("marquee_mqtt_messages_total", "MQTT payloads received.",
+                     mqtt_payload.received());
+  metrics.AddCounter("marquee_mqtt_payloads_dropped_total",
+                     "MQTT payloads dropped because a piece was missing.",
+                     mqtt_payload.dropped());
+  metrics.AddCounter("marquee_mqtt_payloads_oversized_total",
+                     "MQTT payloads dropped for being too large.",
+                     mqtt_payload.oversized());
+  metrics.AddCounter("marquee_mqtt_disconnects_total",
+                     "Times the MQTT connection was lost.", mqtt_disconnects);
+
+  metrics.AddCounter("marquee_stream_frames_total",
+                     "Frames received from a pixel stream.",
+                     pixel_stream.frames());
+  metrics.AddCounter("marquee_stream_late_packets_total",
+                     "Stream packets for frames that were already done.",
+                     pixel_stream.late());
+  metrics.AddCounter("marquee_stream_incomplete_frames_total",
+                     "Stream frames that never got their push.",
+                     pixel_stream.incomplete());
+  metrics.AddCounter("marquee_stream_overruns_total",
+                     "Stream frames dropped because the buffer was full.",
+                     pixel_stream.overruns());
+  metrics.AddCounter("marquee_stream_underruns_total",
+                     "Times the stream buffer ran dry.",
+                     pixel_stream.underruns());
+
+  metrics.AddGauge("marquee_free_heap_bytes", "Free heap.", ESP.getFreeHeap());
+  metrics.AddGauge("marquee_min_free_heap_bytes",
+                   "Least free heap since startup.", ESP.getMinFreeHeap());
+  metrics.AddGauge("marquee_largest_free_block_bytes",
+                   "Largest block of heap that can be allocated.",
+                   ESP.getMaxAllocHeap());
+  metrics.AddGauge("marquee_render_stack_free_bytes",
+                   "Least stack the render task has had free.",
+                   uxTaskGetStackHighWaterMark(render_task));
+  metrics.AddGauge("marquee_wifi_rssi_dbm", "WiFi signal strength.",
+                   WiFi.RSSI());
+  metrics.AddGauge("marquee_uptime_seconds", "Time since startup.",
+                   static_cast<double>(esp_timer_get_time()) / 1e6);
+
+  return metrics.text();
+}
+
+// Publishes the metrics to <node>/metrics every kMetricsPublishSeconds, for
+// signs that nothing scrapes
+void PublishMetrics() {
+  static unsigned long last_publish = 0;
+
+  if (kMetricsPublishSeconds == 0 || !mqtt_client.connected()) return;
+  if (millis() - last_publish < kMetricsPublishSeconds * 1000) return;
+  last_publish = millis();
+
+  const String topic = mqtt_node_topic + "/metrics";
+  const std::string payload = WriteMetrics();
+  mqtt_client.publish(topic.c_str(), 0, false, payload.data(), payload.size());
+}
+
+// The controls script doesn't need anything back; a plain form submission
+// goes back to the page
+void RespondToControl(AsyncWebServerRequest *request) {
+  if (request->hasHeader("X-Requested-With")) {
+    request->send(204);
+  } else {
+    request->redirect("/");
+  }
+}
+
+// A control message from a web client, with the same display settings as
+// /display, and/or text to show, e.g. {"speed": 30, "text": "Hi"}. Text is
+// shown right away unless "queue" is true.
+void HandleWsMessage(JsonDocument &json) {
+  std::vector<RenderCommand> commands;
+  AddDisplayCommands(json.as<JsonObjectConst>(), commands);
+  SetControls(commands);
+
+  if (!json.containsKey("text")) return;
+  const std::string_view text = InterpolateMessage(json["text"]);
+  if (json["queue"] == true) {
+    QueueMessage(text);
+  } else {
+    PostCommand(json["scroll"] == false ? RenderCommand::Type::kStaticText
+                                        : RenderCommand::Type::kScrollText,
+                text);
+  }
+}
+
+void OnWsEvent(AsyncWebSocket *, AsyncWebSocketClient *, AwsEventType type,
+              void *arg, uint8_t *data, size_t len) {
+  switch (type) {
+    case WS_EVT_CONNECT:
+      preview_viewers++;
+      preview_key_frame = true;
+      break;
+    case WS_EVT_DISCONNECT:
+      preview_viewers--;
+      break;
+    case WS_EVT_DATA: {
+      // Controls are small, so only whole messages in a single frame are
+      // taken
+      const auto *info = static_cast<AwsFrameInfo *>(arg);
+      if (info->opcode != WS_TEXT || !info->final || info->index != 0 ||
+          info->len != len || len > kMaxMqttPayload) {
+        debug_println("Ignoring WebSocket message");
+        return;
+      }
+      Trace(TraceEvent::kWebSocketMessage, static_cast<uint32_t>(len));
+
+      // Same task as MQTT, but a document of its own
+      static JsonDocument json;
+      auto deserialize_error =
+          deserializeJson(json, reinterpret_cast<const char *>(data), len);
+      if (deserialize_error) {
+        debug_print("failed to parse WebSocket message: ");
+        debug_println(deserialize_error.c_str());
+        return;
+      }
+      HandleWsMessage(json);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+// Sends web clients what's changed on the display since the last preview.
+// Runs in loop(), below the render task, so encoding never holds up a frame.
+void SendPreview() {
+  static std::vector<uint8_t> encoded;
+
+  if (preview_viewers == 0) return;
+  // Someone's behind; the next frame will catch them up
+  if (!ws.availableForWriteAll()) return;
+
+  const bool key_frame = preview_key_frame.exchange(false);
+  const uint32_t start = TraceTime();
+  if (preview.Encode(encoded, key_frame)) {
+    // Only traced when there's something to send, since this runs all the
+    // time
+    Trace(TraceEvent::kPreviewBegin, 0, start);
+    ws.binaryAll(encoded.data(), encoded.size());
+    Trace(TraceEvent::kPreviewEnd, static_cast<uint32_t>(encoded.size()));
+  }
+}
+
+// Reads the list of web assets on web_fs, if there is one
+bool LoadAssetManifest() {
+  File file = web_fs->open(kAssetManifestFileName, "r");
+  if (!file) return false;
+
+  std::string text(file.size(), '\0');
+  file.readBytes(&text[0], text.size());
+  file.close();
+  return web_assets.Parse(text);
+}
+
+// Serves a web asset, as it's stored (i.e. gzipped), with its ETag. Pages are
+// checked each time, but they ask for everything else by version (?v=<etag>),
+// which never changes, so that can be kept for good. Returns false if it's not
+// an asset.
+bool ServeAsset(AsyncWebServerRequest *request) {
+  if (request->method() != HTTP_GET) return false;
+
+  String path = request->url();
+  if (path.endsWith("/")) path += "index.html";
+  const auto *asset = web_assets.Find(AsView(path));
+  if (!asset) return false;
+
+  const String etag = "\"" + String(asset->etag.c_str()) + "\"";
+  AsyncWebServerResponse *response =
+      request->header("If-None-Match") == etag
+          ? request->beginResponse(304)
+          : request->beginResponse(*web_fs, "/www" + path);
+  response->addHeader("ETag", etag);
+  response->addHeader("Cache-Control",
+                      request->hasParam("v")
+                          ? "public, max-age=31536000, immutable"
+                          : "no-cache");
+  request->send(response);
+  return true;
+}
+
 void InitWebServer() {
-  server.serveStatic("/", *web_fs, "/www/").setDefaultFile("index.html");
+  ws.onEvent(OnWsEvent);
+  server.addHandler(&ws);
+
+  // Assets in the manifest are served by onNotFound, once nothing else wants
+  // the request. Without one, the files are served as they are.
+  if (!LoadAssetManifest()) {
+    debug_println("No web asset manifest, serving files uncached");
+    server.serveStatic("/", *web_fs, "/www/").setDefaultFile("index.html");
+  }
 
   server.on("/text", HTTP_POST, [](AsyncWebServerRequest *request) {
     if (auto param_text = request->getParam("text", true)) {
+      // Compiled like any other message, so that it can't carry raw ops
+      const std::string_view text =
+          InterpolateMessage(AsView(param_text->value()));
       if (request->getParam("do_queue", true))
-        scroll_next = param_text->value();
+        QueueMessage(text);
       else
-        layout->text().ShowScrollText(param_text->value());
+        PostCommand(RenderCommand::Type::kScrollText, text);
     }
 
     request->redirect("/");
@@ -525,34 +1399,51 @@ void InitWebServer() {
       String color = param_color->value();
       if (color.length() == 7) {
         unsigned long rgbl = strtoul(color.c_str() + 1, NULL, 16);
-        uint8_t b = rgbl & 0xff;
-        uint8_t g = (rgbl >> 8) & 0xff;
-        uint8_t r = (rgbl >> 16) & 0xff;
-        layout->text().SetColorRgb(r, g, b);
+        SetControl(RenderCommand::Type::kTextColor, rgbl & 0xffffff);
       }
     }
 
-    request->redirect("/");
+    RespondToControl(request);
   });
 
   server.on("/brightness", HTTP_POST, [](AsyncWebServerRequest *request) {
     if (auto param_brightness = request->getParam("brightness", true)) {
-      display_manager->SetBrightness(param_brightness->value().toInt());
+      SetControl(RenderCommand::Type::kBrightness,
+                 constrain(param_brightness->value().toInt(), 0, 255));
     }
 
-    request->redirect("/");
+    RespondToControl(request);
   });
 
   server.on("/speed", HTTP_POST, [](AsyncWebServerRequest *request) {
     if (auto param_speed = request->getParam("speed", true)) {
-      scroll_speed = param_speed->value().toInt();
-      scroll_timer->setPeriod(scroll_speed);
+      const long speed = param_speed->value().toInt();
+      if (speed > 0) SetControl(RenderCommand::Type::kSpeed, speed);
     }
 
-    request->redirect("/");
+    RespondToControl(request);
+  });
+
+  server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+    request->send(200, "text/plain; version=0.0.4",
+                  String(WriteMetrics().c_str()));
+  });
+
+  // Decoded by scripts/decode_trace.py
+  server.on("/trace", HTTP_GET, [](AsyncWebServerRequest *request) {
+    std::vector<led_marquee::TraceRecord> records;
+    trace_ring.Snapshot(records);
+    std::vector<uint8_t> dump;
+    led_marquee::WriteTrace(records, TraceTime(), dump);
+
+    auto *response = request->beginResponseStream("application/octet-stream");
+    response->write(dump.data(), dump.size());
+    request->send(response);
   });
 
   server.onNotFound([](AsyncWebServerRequest *request) {
+    if (ServeAsset(request)) return;
+
     auto *response = request->beginResponse(*web_fs, "/www/404.html");
     response->setCode(404);
     request->send(response);
@@ -567,7 +1458,13 @@ void InitMain() {
 
   InitMqtt();
 
-  layout->text().ShowScrollText(kStartupMessage);
+  if (pixel_udp.listen(led_marquee::PixelStream::kPort)) {
+    pixel_udp.onPacket([](AsyncUDPPacket &packet) {
+      pixel_stream.Receive(packet.data(), packet.length(), millis());
+    });
+  }
+
+  PostCommand(RenderCommand::Type::kScrollText, kStartupMessage);
 }
 
 void InitArduinoOTA() {
@@ -578,17 +1475,27 @@ void InitArduinoOTA() {
 
   static led_marquee::TextLayout ota_message(*display_manager, MatriseFontData,
                                              1);
+  // The OTA callbacks draw directly, once the render task has stood down
+  static bool ota_display = false;
 
   ArduinoOTA.onStart([]() {
+    ota_display = StopRendering();
+    if (!ota_display) {
+      debug_println("Render task didn't stop, not showing OTA progress");
+      return;
+    }
+
     ota_message.text().SetColorRgb(0xff, 0xff, 0x00);
-    ota_message.text().SetBackgroundMode(BACKGND_LEAVE);
-    FastLED.clear();
-    ota_message.text().ShowStaticText("OTA UPDATE");
+    ota_message.text().SetBackgroundMode(
+        led_marquee::TextRenderer::Background::kLeave);
+    display_manager->Clear();
+    ShowStaticTextNow(ota_message.text(), "OTA UPDATE");
   });
 
   ArduinoOTA.onProgress([](unsigned int progress, unsigned int total) {
     char progress_text[22];
 
+    if (!ota_display) return;
     EVERY_N_SECONDS(1) {
       float pct = static_cast<float>(progress) / static_cast<float>(total);
       uint16_t w = display_manager->GetWidth() - 1;
@@ -596,11 +1503,10 @@ void InitArduinoOTA() {
       snprintf(progress_text, sizeof(progress_text), "OTA UPDATE: %u%%",
                int(100.0 * pct));
 
-      FastLED.clear();
-      display_manager->FillArea(0, 0, w * pct, 0, CRGB::DarkGreen);
-      ota_message.text().ShowStaticText(progress_text);
-
-      FastLED.show();
+      display_manager->Clear();
+      display_manager->FillArea(0, 0, static_cast<int>(w * pct), 1,
+                                led_marquee::Rgb{0x00, 0x64, 0x00});
+      ShowStaticTextNow(ota_message.text(), progress_text);
     }
   });
 
@@ -626,8 +1532,10 @@ void InitArduinoOTA() {
         error_text = "UNKNOWN OTA ERROR";
     }
 
-    FastLED.clear();
-    ota_message.text().ShowStaticText(error_text);
+    if (ota_display) {
+      display_manager->Clear();
+      ShowStaticTextNow(ota_message.text(), error_text);
+    }
 
     delay(5000);
     ESP.restart();
@@ -642,7 +1550,7 @@ void RebootIfDisconnected(byte &disconnect_count) {
     disconnect_count++;
     debug_println(String("WL_DISCONNECTED count: ") + disconnect_count);
     if (disconnect_count > 1) {
-      layout->text().ShowStaticText("DISCONNECTED");
+      PostCommand(RenderCommand::Type::kStaticText, "DISCONNECTED");
       delay(3000);
       ESP.restart();
     }
@@ -664,6 +1572,7 @@ void CheckForStartup() {
 }
 
 void setup() {
+  loop_task = xTaskGetCurrentTaskHandle();
   WiFi.mode(WIFI_STA);  // explicitly set mode, esp defaults to STA+AP
 
   pinMode(kResetPin, INPUT_PULLUP);
@@ -672,10 +1581,11 @@ void setup() {
   debug_setDebugOutput(true);
 
   InitLEDs();
+  WatchZoneTopics();
 
   CheckForResetConfig();
 
-  layout->text().ShowStaticText("START");
+  ShowStaticTextNow(layout->text(), "START");
 
   config.AddParam("hostname", "mDNS hostname", "", 63);
   config.AddHtml("<hr /><p>Leave MQTT host blank to disable MQTT.</p>");
@@ -693,7 +1603,7 @@ void setup() {
 
   LoadUserConfig();
 
-  scroll_timer = new CEveryNMillis(scroll_speed);
+  StartRenderTask();
 
   SetupWiFiManager();
 
@@ -717,29 +1627,13 @@ void loop() {
   // Run asynchronous OTA receiver
   if (enable_ota) ArduinoOTA.handle();
 
-  // Do the scrolling
-  if (*scroll_timer) {
-    if (enable_display) {
-      AnimateScroller();
-      FastLED.show();
-    } else {
-      FastLED.clear(true);
-    }
-  } else if (enable_clock) {
-    EVERY_N_SECONDS(1) {
-      clock_hue++;
-      SetClockColor();
-
-      time_t now = time(NULL);
-      tm *timeinfo = localtime(&now);
-      char t[40];
-      strftime(t, sizeof(t), "%l:%M:%S", timeinfo);
-      layout->clock().SetText(t);
-    }
-  }
+  SendPreview();
+  PublishReady();
+  PublishMetrics();
 
   // Periodic housekeeping. Run every 5 seconds to not waste CPU.
   EVERY_N_SECONDS(5) {
+    ws.cleanupClients();
     RebootIfDisconnected(disconnectCount);
     CheckForStartup();
   }
@@ -749,9 +1643,8 @@ void loop() {
     delay(50);
     if (digitalRead(kResetPin) == LOW) {
       config_mode = true;
-      RemoveClock();
-      layout->text().ShowScrollText("CONFIG: http://" +
-                                    WiFi.localIP().toString());
+      PostCommand(RenderCommand::Type::kConfigMode,
+                  AsView("CONFIG: http://" + WiFi.localIP().toString()));
       debug_println("Enter WebPortal");
       server.end();
       wm->setParamsPage(true);
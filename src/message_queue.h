@@ -0,0 +1,136 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_MESSAGE_QUEUE_H_
+#define LED_MARQUEE_MESSAGE_QUEUE_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace led_marquee {
+
+// Bounded lock-free queue, safe for any number of producers and consumers.
+// Used to hand messages from the network tasks to the render task without
+// either one blocking the other. When it's full, Push() fails and the value is
+// counted as dropped.
+//
+// This is Dmitry Vyukov's bounded MPMC queue: each cell carries a sequence
+// number that says whether it's ready to be written or read for a given
+// position, so producers and consumers only contend on their own counters.
+template <typename T, std::size_t Capacity>
+class MessageQueue {
+  static_assert(Capacity > 0, "MessageQueue needs at least one slot");
+
+ public:
+  MessageQueue() {
+    for (std::size_t i = 0; i < Capacity; i++) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Not copyable or movable
+  MessageQueue(const MessageQueue &) = delete;
+  MessageQueue &operator=(const MessageQueue &) = delete;
+
+  bool Push(T value) {
+    std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;) {
+      cell = &cells_[pos % Capacity];
+      const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const auto diff =
+          static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // Full
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->value = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    pushed_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool Pop(T &value) {
+    std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;) {
+      cell = &cells_[pos % Capacity];
+      const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq) -
+                        static_cast<std::ptrdiff_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // Empty
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    value = std::move(cell->value);
+    cell->sequence.store(pos + Capacity, std::memory_order_release);
+    return true;
+  }
+
+  // Number of values waiting. Only a snapshot if other tasks are busy with
+  // the queue.
+  std::size_t Size() const {
+    const std::size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+    const std::size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+  }
+  bool Empty() const { return Size() == 0; };
+  static constexpr std::size_t capacity() { return Capacity; };
+
+  // Totals since startup
+  uint32_t pushed() const { return pushed_.load(std::memory_order_relaxed); };
+  uint32_t dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  };
+
+ private:
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    T value;
+  };
+
+  Cell cells_[Capacity];
+  std::atomic<std::size_t> enqueue_pos_{0};
+  std::atomic<std::size_t> dequeue_pos_{0};
+  std::atomic<uint32_t> pushed_{0};
+  std::atomic<uint32_t> dropped_{0};
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_MESSAGE_QUEUE_H_
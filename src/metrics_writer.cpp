@@ -0,0 +1,71 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "metrics_writer.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace led_marquee {
+
+void MetricsWriter::AddCounter(std::string_view name, std::string_view help,
+                               uint64_t value) {
+  AddHeader(name, help, "counter");
+  text_.append(name).append(" ").append(std::to_string(value)).append("\n");
+}
+
+void MetricsWriter::AddGauge(std::string_view name, std::string_view help,
+                             double value) {
+  AddHeader(name, help, "gauge");
+  AddSample(name, "", value);
+}
+
+void MetricsWriter::AddHistogram(std::string_view name, std::string_view help,
+                                 const uint32_t *bounds,
+                                 const uint32_t *buckets, std::size_t size,
+                                 uint32_t count, uint64_t sum, double scale) {
+  AddHeader(name, help, "histogram");
+
+  const std::string bucket = std::string(name) + "_bucket";
+  uint32_t total = 0;
+  char label[32];
+  for (std::size_t i = 0; i < size; i++) {
+    total += buckets[i];
+    snprintf(label, sizeof(label), "{le=\"%g\"}", bounds[i] * scale);
+    AddSample(bucket, label, total);
+  }
+  // Everything, including what's above the last bound
+  AddSample(bucket, "{le=\"+Inf\"}", count);
+  AddSample(std::string(name) + "_sum", "", static_cast<double>(sum) * scale);
+  AddSample(std::string(name) + "_count", "", count);
+}
+
+void MetricsWriter::AddHeader(std::string_view name, std::string_view help,
+                              std::string_view type) {
+  text_.append("# HELP ").append(name).append(" ").append(help).append("\n");
+  text_.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+void MetricsWriter::AddSample(std::string_view name, std::string_view labels,
+                              double value) {
+  char formatted[32];
+  snprintf(formatted, sizeof(formatted), "%.10g", value);
+  text_.append(name).append(labels).append(" ").append(formatted).append("\n");
+}
+
+}  // namespace led_marquee
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_METRICS_WRITER_H_
+#define LED_MARQUEE_METRICS_WRITER_H_
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "histogram.h"
+
+namespace led_marquee {
+
+// Writes metrics in the Prometheus text format, e.g.
+//
+//   # HELP marquee_messages_shown_total Messages taken off the queue.
+//   # TYPE marquee_messages_shown_total counter
+//   marquee_messages_shown_total 12
+//
+// Names should follow Prometheus conventions: counters end in _total, and
+// values are in base units (seconds, bytes).
+class MetricsWriter {
+ public:
+  void AddCounter(std::string_view name, std::string_view help,
+                  uint64_t value);
+  void AddGauge(std::string_view name, std::string_view help, double value);
+
+  // Values are recorded as integers in some smaller unit; `scale` converts
+  // them to the metric's, e.g. 1e-6 for microseconds to seconds.
+  template <std::size_t N>
+  void AddHistogram(std::string_view name, std::string_view help,
+                    const Histogram<N> &histogram, double scale) {
+    std::vector<uint32_t> buckets(N);
+    for (std::size_t i = 0; i < N; i++) buckets[i] = histogram.bucket(i);
+    AddHistogram(name, help, histogram.bounds().data(), buckets.data(), N,
+                 histogram.count(), histogram.sum(), scale);
+  }
+
+  const std::string &text() const { return text_; };
+
+ private:
+  void AddHistogram(std::string_view name, std::string_view help,
+                    const uint32_t *bounds, const uint32_t *buckets,
+                    std::size_t size, uint32_t count, uint64_t sum,
+                    double scale);
+  void AddHeader(std::string_view name, std::string_view help,
+                 std::string_view type);
+  void AddSample(std::string_view name, std::string_view labels,
+                 double value);
+
+  std::string text_;
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_METRICS_WRITER_H_
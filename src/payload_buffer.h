@@ -0,0 +1,114 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_PAYLOAD_BUFFER_H_
+#define LED_MARQUEE_PAYLOAD_BUFFER_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <cstddef>
+#include <string_view>
+
+namespace led_marquee {
+
+// Puts MQTT payloads back together. AsyncMqttClient hands over anything larger
+// than its receive buffer in pieces, each with its offset into the whole
+// payload; feed them to Add() as they come and it says when the payload is
+// complete.
+//
+// Pieces of one message always arrive in order and aren't interleaved with
+// other messages, so a single buffer is enough. Payloads larger than Capacity,
+// and ones that are missing a piece, are counted and thrown away.
+template <std::size_t Capacity>
+class PayloadBuffer {
+ public:
+  PayloadBuffer() = default;
+
+  // Not copyable
+  PayloadBuffer(const PayloadBuffer &) = delete;
+  PayloadBuffer &operator=(const PayloadBuffer &) = delete;
+
+  // Adds `len` bytes found at `index` in a payload of `total` bytes. Returns
+  // true if that completes it, in which case it's in payload() until the next
+  // call.
+  bool Add(const char *data, std::size_t len, std::size_t index,
+           std::size_t total) {
+    if (index == 0) {
+      // A new payload. Anything already underway isn't going to be finished.
+      if (filling_) dropped_.fetch_add(1, std::memory_order_relaxed);
+      filling_ = false;
+      size_ = 0;
+      total_ = total;
+
+      if (total > Capacity) {
+        oversized_.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        filling_ = true;
+      }
+    }
+    if (total > Capacity) return false;
+
+    // Either the rest of a payload that was thrown away, or a piece is missing
+    if (!filling_) return false;
+    if (index != size_ || total != total_ || len > total_ - size_) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      filling_ = false;
+      return false;
+    }
+
+    memcpy(buffer_ + size_, data, len);
+    size_ += len;
+    if (size_ < total_) return false;
+
+    filling_ = false;
+    buffer_[size_] = '\0';
+    received_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // The last complete payload, followed by a '\0' that isn't counted in its
+  // size.
+  std::string_view payload() const { return {buffer_, size_}; };
+  static constexpr std::size_t capacity() { return Capacity; };
+
+  // Totals since startup
+  uint32_t received() const {
+    return received_.load(std::memory_order_relaxed);
+  };
+  uint32_t dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  };
+  uint32_t oversized() const {
+    return oversized_.load(std::memory_order_relaxed);
+  };
+
+ private:
+  char buffer_[Capacity + 1];
+  std::size_t size_ = 0;
+  std::size_t total_ = 0;
+  bool filling_ = false;
+
+  // Read by other tasks
+  std::atomic<uint32_t> received_{0};
+  std::atomic<uint32_t> dropped_{0};
+  std::atomic<uint32_t> oversized_{0};
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_PAYLOAD_BUFFER_H_
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_PENDING_CONTROLS_H_
+#define LED_MARQUEE_PENDING_CONTROLS_H_
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <cstddef>
+
+#include "render_command.h"
+
+namespace led_marquee {
+
+// The latest setting of each control, e.g. color or brightness, waiting for
+// the render task. Controls can change far faster than frames go by, like
+// while dragging a slider, and only the last value before a frame matters.
+// Setting a control that's still pending replaces it, and counts as
+// coalesced. Safe for any number of tasks.
+//
+// Controls set together, by one call to Set(), are taken together: TakeAll()
+// never sees some of them without the rest.
+//
+// Controls can also be changed some other way, like the settings in a batch
+// of commands, with Stamp() and Supersede() putting them in order with Set(),
+// so that the latest write to each control wins either way.
+class PendingControls {
+ public:
+  // Whether `type` is one of the controls, which are just a `value`
+  static constexpr bool IsControl(RenderCommand::Type type) {
+    return type >= RenderCommand::Type::kTextColor &&
+           type <= RenderCommand::Type::kEnable;
+  };
+
+  void Set(RenderCommand::Type type, uint32_t value) {
+    const RenderCommand command{type, value};
+    Set(&command, 1);
+  }
+
+  // Sets all of `commands`, which must be controls, as one change
+  void Set(const RenderCommand *commands, std::size_t count) {
+    writers_.fetch_add(1);
+    const uint64_t epoch = NextEpoch();
+    for (std::size_t i = 0; i < count; i++) {
+      assert(IsControl(commands[i].type));
+      auto &slot = slots_[SlotIndex(commands[i].type)];
+      const uint64_t entry = epoch << 32 | commands[i].value;
+
+      // Another task may be setting the same control; the later change wins
+      // even if it gets here first
+      uint64_t old = slot.load();
+      do {
+        if (old && IsAfter(EpochOf(old), EpochOf(entry))) break;
+      } while (!slot.compare_exchange_weak(old, entry));
+      if (old) coalesced_.fetch_add(1, std::memory_order_relaxed);
+    }
+    updates_.fetch_add(static_cast<uint32_t>(count),
+                       std::memory_order_relaxed);
+    writers_.fetch_sub(1);
+  }
+
+  // Orders a change to controls made some other way against Set(). It's
+  // as if they were set now.
+  uint32_t Stamp() { return NextEpoch(); };
+
+  // Calls `fn` with a RenderCommand for each control that's been set since
+  // last time, unless something later was applied with Supersede(). If
+  // another task is partway through a Set(), takes nothing, to be tried again
+  // next time; that's over in a few microseconds.
+  //
+  // Only for the one task that applies controls, as is Supersede().
+  template <typename Fn>
+  void TakeAll(Fn fn) {
+    uint64_t taken[kSlots];
+    if (!Snapshot(taken)) return;
+
+    for (std::size_t i = 0; i < kSlots; i++) {
+      if (!taken[i]) continue;
+      // If it's been set again since, leave the new value for next time. That
+      // Set() counted this one as coalesced, but it's applied after all.
+      uint64_t expected = taken[i];
+      if (!slots_[i].compare_exchange_strong(expected, 0)) {
+        coalesced_.fetch_sub(1, std::memory_order_relaxed);
+      }
+      if (!Supersede(ControlType(i), EpochOf(taken[i]))) continue;
+      fn(RenderCommand{ControlType(i), static_cast<uint32_t>(taken[i])});
+    }
+  }
+
+  // Notes that a value for `type` from `epoch` (see Stamp()) is being
+  // applied. Returns false if a later one already has been, and this one
+  // should be skipped.
+  bool Supersede(RenderCommand::Type type, uint32_t epoch) {
+    uint32_t &applied = applied_[SlotIndex(type)];
+    if (applied && !IsAfter(epoch, applied)) return false;
+    applied = epoch;
+    return true;
+  }
+
+  // Totals since startup
+  uint32_t updates() const {
+    return updates_.load(std::memory_order_relaxed);
+  };
+  // Updates that were replaced before they were applied
+  uint32_t coalesced() const {
+    return coalesced_.load(std::memory_order_relaxed);
+  };
+
+ private:
+  static constexpr std::size_t kSlots =
+      static_cast<std::size_t>(RenderCommand::Type::kEnable) -
+      static_cast<std::size_t>(RenderCommand::Type::kTextColor) + 1;
+  // Times to look again when a Set() finished while taking a snapshot
+  static constexpr int kSnapshotAttempts = 4;
+
+  static std::size_t SlotIndex(RenderCommand::Type type) {
+    return static_cast<std::size_t>(type) -
+           static_cast<std::size_t>(RenderCommand::Type::kTextColor);
+  };
+  static RenderCommand::Type ControlType(std::size_t index) {
+    return static_cast<RenderCommand::Type>(
+        index + static_cast<std::size_t>(RenderCommand::Type::kTextColor));
+  };
+  static uint32_t EpochOf(uint64_t entry) {
+    return static_cast<uint32_t>(entry >> 32);
+  };
+  // Whether epoch `a` came after `b`, allowing for wrapping around
+  static bool IsAfter(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) > 0;
+  };
+
+  // Never 0, which marks an empty slot
+  uint32_t NextEpoch() {
+    uint32_t epoch;
+    do {
+      epoch = epoch_.fetch_add(1) + 1;
+    } while (epoch == 0);
+    return epoch;
+  }
+
+  // Copies every slot, if no Set() overlapped with the copy
+  bool Snapshot(uint64_t (&taken)[kSlots]) {
+    for (int attempt = 0; attempt < kSnapshotAttempts; attempt++) {
+      const uint32_t epoch = epoch_.load();
+      if (writers_.load()) return false;
+      for (std::size_t i = 0; i < kSlots; i++) taken[i] = slots_[i].load();
+      if (!writers_.load() && epoch_.load() == epoch) return true;
+    }
+    return false;
+  }
+
+  // Each slot is the epoch of the Set() that filled it, in the top half, and
+  // the value, or 0 if there's nothing pending
+  std::atomic<uint64_t> slots_[kSlots] = {};
+  // Counts calls to Set()
+  std::atomic<uint32_t> epoch_{0};
+  // Set() calls in progress
+  std::atomic<uint32_t> writers_{0};
+  std::atomic<uint32_t> updates_{0};
+  std::atomic<uint32_t> coalesced_{0};
+  // The epoch of the last value applied to each control, or 0 for none. Only
+  // the applying task touches these.
+  uint32_t applied_[kSlots] = {};
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_PENDING_CONTROLS_H_
@@ -0,0 +1,177 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pixel_stream.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <mutex>
+
+#include "framebuffer.h"
+#include "rgb.h"
+
+namespace led_marquee {
+
+PixelStream::PixelStream(int width, int height, int jitter_frames,
+                         uint32_t timeout_ms)
+    : width_(width),
+      height_(height),
+      jitter_frames_(std::max(jitter_frames, 1)),
+      timeout_ms_(timeout_ms),
+      // Room for a couple of frames more than the jitter buffer holds, and the
+      // one being received
+      slots_(static_cast<size_t>(jitter_frames_ + 3),
+             Frame(static_cast<size_t>(width * height))),
+      last_(static_cast<size_t>(width * height)) {}
+
+bool PixelStream::Receive(const uint8_t *data, size_t size, uint32_t now_ms) {
+  if (size < kHeaderSize) return false;
+
+  const uint8_t flags = data[0];
+  if ((flags & kVersionMask) != kVersion1 || (flags & kQuery)) return false;
+
+  const uint8_t type = data[2];
+  if (type != kTypeRgb8 && type != kTypeLegacyRgb &&
+      type != kTypeUnspecified) {
+    return false;
+  }
+
+  // The timecode, if there is one, isn't used
+  const size_t header = (flags & kTimecode) ? kHeaderSize + 4 : kHeaderSize;
+  const size_t offset = static_cast<size_t>(data[4]) << 24 |
+                        static_cast<size_t>(data[5]) << 16 |
+                        static_cast<size_t>(data[6]) << 8 | data[7];
+  const size_t length = static_cast<size_t>(data[8]) << 8 | data[9];
+  if (size < header + length) return false;
+
+  const uint8_t sequence = data[1] & 0x0f;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // After a break, start over rather than play what was left from before
+  if (!Active(now_ms)) {
+    count_ = 0;
+    playing_ = false;
+    pushed_sequence_ = 0;
+  }
+
+  // Sequence numbers are optional (0 is unsequenced), and wrap around after
+  // 15, so one that's up to half the range behind is a straggler
+  if (sequence != 0 && pushed_sequence_ != 0 &&
+      ((pushed_sequence_ - sequence) & 0x0f) < 8) {
+    late_++;
+    return true;
+  }
+
+  if (assembling_ && sequence != sequence_) {
+    incomplete_++;
+    assembling_ = false;
+  }
+  if (!assembling_) StartFrame(sequence);
+
+  CopyPixels(data + header, offset, length);
+  if (flags & kPush) PushFrame(now_ms);
+
+  return true;
+}
+
+bool PixelStream::Active(uint32_t now_ms) const {
+  return received_ && now_ms - last_frame_ms_ <= timeout_ms_;
+}
+
+bool PixelStream::NextFrame(Framebuffer &frame) {
+  assert(frame.size() == last_.size());
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!playing_) {
+    if (count_ < static_cast<size_t>(jitter_frames_)) return false;
+    playing_ = true;
+  }
+  if (count_ == 0) {
+    playing_ = false;
+    underruns_++;
+    return false;
+  }
+
+  std::copy(slots_[read_].begin(), slots_[read_].end(), frame.data());
+  read_ = (read_ + 1) % slots_.size();
+  count_--;
+  return true;
+}
+
+void PixelStream::StartFrame(uint8_t sequence) {
+  Assembling() = last_;
+  sequence_ = sequence;
+  assembling_ = true;
+}
+
+void PixelStream::CopyPixels(const uint8_t *data, size_t offset,
+                             size_t length) {
+  Frame &pixels = Assembling();
+  // Anything past the end of the display is ignored
+  const size_t end = std::min(offset + length, pixels.size() * 3);
+  const auto width = static_cast<size_t>(width_);
+  const auto height = static_cast<size_t>(height_);
+
+  for (size_t i = offset; i < end; i++) {
+    // Rows from the top, into columns from the bottom
+    const size_t pixel = i / 3;
+    const size_t x = pixel % width;
+    const size_t y = height - 1 - pixel / width;
+    Rgb &rgb = pixels[x * height + y];
+
+    const uint8_t value = data[i - offset];
+    switch (i % 3) {
+      case 0:
+        rgb.r = value;
+        break;
+      case 1:
+        rgb.g = value;
+        break;
+      default:
+        rgb.b = value;
+        break;
+    }
+  }
+}
+
+void PixelStream::PushFrame(uint32_t now_ms) {
+  last_ = Assembling();
+  assembling_ = false;
+  pushed_sequence_ = sequence_;
+
+  if (++count_ == slots_.size()) {
+    // Full, so the oldest frame goes
+    read_ = (read_ + 1) % slots_.size();
+    count_--;
+    overruns_++;
+  }
+
+  if (received_) {
+    const uint32_t since_last = now_ms - last_frame_ms_;
+    if (since_last <= timeout_ms_) {
+      // Smoothed, since packets don't arrive as evenly as they were sent
+      const int interval = static_cast<int>(std::min(since_last, 1000u)) * 16;
+      interval_16ths_ += (interval - interval_16ths_) / 4;
+    }
+  }
+  last_frame_ms_ = now_ms;
+  received_ = true;
+  frames_++;
+}
+
+}  // namespace led_marquee
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_PIXEL_STREAM_H_
+#define LED_MARQUEE_PIXEL_STREAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "framebuffer.h"
+#include "rgb.h"
+
+namespace led_marquee {
+
+// Frames streamed over UDP by something else, e.g. a server rendering
+// animations that are too much for the ESP32. While frames keep coming they
+// go straight to the display, in place of the text.
+//
+// Packets are DDP (Distributed Display Protocol, as spoken by xLights, WLED
+// and friends): a 10-byte header, then RGB data at a byte offset into the
+// frame. Pixels are in rows from the top left, like an image. A packet with
+// the push flag completes the frame; anything it doesn't cover is left as it
+// was in the previous one. The 4-bit sequence number in each packet is used
+// to spot stragglers from frames that have already been completed.
+//
+// Completed frames wait in a small jitter buffer, so that uneven arrival
+// doesn't show up as uneven motion: playback starts once `jitter_frames` are
+// waiting, and goes at the rate they're sent. If it runs dry, it waits for the
+// buffer to fill again. Once no frames have arrived for `timeout_ms`, the
+// stream is over.
+//
+// Receive() is for the network task, the rest for the render task.
+class PixelStream {
+ public:
+  // DDP's port
+  static constexpr uint16_t kPort = 4048;
+  static constexpr size_t kHeaderSize = 10;
+
+  // Header flags
+  static constexpr uint8_t kVersion1 = 0x40;
+  static constexpr uint8_t kVersionMask = 0xc0;
+  static constexpr uint8_t kTimecode = 0x10;
+  static constexpr uint8_t kQuery = 0x02;
+  static constexpr uint8_t kPush = 0x01;
+  // Data types: RGB with 8 bits per channel, or unspecified
+  static constexpr uint8_t kTypeRgb8 = 0x0b;
+  static constexpr uint8_t kTypeLegacyRgb = 0x01;
+  static constexpr uint8_t kTypeUnspecified = 0x00;
+
+  PixelStream(int width, int height, int jitter_frames = 2,
+              uint32_t timeout_ms = 2500);
+
+  // Not copyable
+  PixelStream(const PixelStream &) = delete;
+  PixelStream &operator=(const PixelStream &) = delete;
+
+  // Handles one packet that arrived at `now_ms`. Returns false if it isn't
+  // pixel data for us.
+  bool Receive(const uint8_t *data, size_t size, uint32_t now_ms);
+
+  // Whether the stream has taken over the display
+  bool Active(uint32_t now_ms) const;
+
+  // Copies the next frame into `frame`, if it's time for one
+  bool NextFrame(Framebuffer &frame);
+
+  // Milliseconds between frames, as they're being sent
+  int FrameInterval() const {
+    return std::max((interval_16ths_.load() + 8) / 16, 5);
+  };
+
+  // Totals since startup
+  uint32_t frames() const { return frames_.load(); };
+  // Packets for frames that had already been completed
+  uint32_t late() const { return late_.load(); };
+  // Frames that never got their push, because the next one started
+  uint32_t incomplete() const { return incomplete_.load(); };
+  // Frames thrown away because the buffer was full
+  uint32_t overruns() const { return overruns_.load(); };
+  // Times the buffer ran dry while playing
+  uint32_t underruns() const { return underruns_.load(); };
+
+ private:
+  using Frame = std::vector<Rgb>;
+
+  // Frames waiting to be shown, plus the one being put together
+  Frame &Assembling() { return slots_[(read_ + count_) % slots_.size()]; };
+  void StartFrame(uint8_t sequence);
+  void CopyPixels(const uint8_t *data, size_t offset, size_t length);
+  void PushFrame(uint32_t now_ms);
+
+  const int width_, height_;
+  const int jitter_frames_;
+  const uint32_t timeout_ms_;
+
+  std::mutex mutex_;
+  std::vector<Frame> slots_;
+  // The last completed frame, which the next one starts from
+  Frame last_;
+  size_t read_ = 0;
+  size_t count_ = 0;
+  bool assembling_ = false;
+  bool playing_ = false;
+  uint8_t sequence_ = 0;
+  uint8_t pushed_sequence_ = 0;
+
+  std::atomic<bool> received_{false};
+  std::atomic<uint32_t> last_frame_ms_{0};
+  // In sixteenths of a millisecond, so that smoothing doesn't round it off
+  std::atomic<int> interval_16ths_{33 * 16};
+
+  std::atomic<uint32_t> frames_{0};
+  std::atomic<uint32_t> late_{0};
+  std::atomic<uint32_t> incomplete_{0};
+  std::atomic<uint32_t> overruns_{0};
+  std::atomic<uint32_t> underruns_{0};
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_PIXEL_STREAM_H_
@@ -0,0 +1,104 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "preview.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include "framebuffer.h"
+#include "rgb.h"
+
+namespace led_marquee {
+
+namespace {
+
+// Longest run either kind of token can cover
+constexpr size_t kMaxRun = 128;
+constexpr uint8_t kColorRun = 0x80;
+
+}  // namespace
+
+Preview::Preview(int width, int height, uint32_t interval_ms)
+    : width_(width),
+      height_(height),
+      interval_ms_(interval_ms),
+      captured_(static_cast<size_t>(width * height)),
+      current_(captured_.size()),
+      sent_(captured_.size()),
+      black_(captured_.size()) {}
+
+void Preview::Capture(const Framebuffer &frame, uint32_t now_ms) {
+  assert(frame.size() == captured_.size());
+  if (now_ms - last_capture_ms_ < interval_ms_) return;
+
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) return;
+
+  std::copy(frame.data(), frame.data() + frame.size(), captured_.begin());
+  fresh_ = true;
+  last_capture_ms_ = now_ms;
+}
+
+bool Preview::Encode(std::vector<uint8_t> &out, bool key_frame) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!fresh_ && !key_frame) return false;
+    current_ = captured_;
+    fresh_ = false;
+  }
+  if (!key_frame && current_ == sent_) return false;
+
+  out.clear();
+  out.push_back(key_frame ? kKeyFrame : kDeltaFrame);
+  for (int dimension : {width_, height_}) {
+    out.push_back(static_cast<uint8_t>(dimension));
+    out.push_back(static_cast<uint8_t>(dimension >> 8));
+  }
+  Append(out, key_frame ? black_ : sent_);
+
+  sent_.swap(current_);
+  return true;
+}
+
+void Preview::Append(std::vector<uint8_t> &out,
+                     const std::vector<Rgb> &base) const {
+  const size_t size = current_.size();
+
+  for (size_t i = 0; i < size;) {
+    size_t run = 1;
+    if (current_[i] == base[i]) {
+      while (i + run < size && run < kMaxRun &&
+             current_[i + run] == base[i + run]) {
+        run++;
+      }
+      out.push_back(static_cast<uint8_t>(run - 1));
+    } else {
+      const Rgb color = current_[i];
+      while (i + run < size && run < kMaxRun && current_[i + run] == color) {
+        run++;
+      }
+      out.insert(out.end(), {static_cast<uint8_t>(kColorRun + run - 1),
+                             color.r, color.g, color.b});
+    }
+    i += run;
+  }
+}
+
+}  // namespace led_marquee
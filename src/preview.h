@@ -0,0 +1,84 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_PREVIEW_H_
+#define LED_MARQUEE_PREVIEW_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mutex>
+#include <vector>
+
+#include "framebuffer.h"
+#include "rgb.h"
+
+namespace led_marquee {
+
+// A low frame rate copy of what's on the display, for watching it remotely.
+// The render task hands over frames with Capture(), which only copies, and
+// only as often as `interval_ms`; the encoding is done by whoever's sending,
+// on their own time.
+//
+// Frames are encoded as changes from the last one, which for scrolling text
+// is mostly nothing:
+//
+//   'K' (a key frame, starting from black) or 'D' (a delta from the last)
+//   width, height: 16 bits each, little endian
+//   then for the pixels in Framebuffer::data() order, i.e. columns from the
+//   left, each from the bottom:
+//     0x00-0x7f: the next n + 1 pixels are unchanged
+//     0x80-0xff: the next n - 0x7f pixels are the color in the 3 bytes that
+//                follow
+class Preview {
+ public:
+  static constexpr uint8_t kKeyFrame = 'K';
+  static constexpr uint8_t kDeltaFrame = 'D';
+  static constexpr size_t kHeaderSize = 5;
+
+  Preview(int width, int height, uint32_t interval_ms);
+
+  // Not copyable
+  Preview(const Preview &) = delete;
+  Preview &operator=(const Preview &) = delete;
+
+  // Takes a copy of `frame` if it's been long enough since the last one.
+  // Never waits for the encoder.
+  void Capture(const Framebuffer &frame, uint32_t now_ms);
+
+  // Encodes the latest frame into `out`. Returns false if there's nothing
+  // new to send. A key frame is sent if asked for, e.g. for a new viewer.
+  bool Encode(std::vector<uint8_t> &out, bool key_frame = false);
+
+ private:
+  void Append(std::vector<uint8_t> &out, const std::vector<Rgb> &base) const;
+
+  const int width_, height_;
+  const uint32_t interval_ms_;
+  uint32_t last_capture_ms_ = 0;
+
+  std::mutex mutex_;
+  std::vector<Rgb> captured_;
+  bool fresh_ = false;
+
+  // Only touched by the encoder
+  std::vector<Rgb> current_, sent_;
+  const std::vector<Rgb> black_;
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_PREVIEW_H_
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_RENDER_COMMAND_H_
+#define LED_MARQUEE_RENDER_COMMAND_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace led_marquee {
+
+// A change to what's on the display. Only the render task touches the layout,
+// so this is how the network callbacks and everything else ask for changes.
+// Commands are copied through a FreeRTOS queue, so they have to stay plain
+// data; text and batches are passed by pointer and belong to whoever ends up
+// with them.
+struct RenderCommand {
+  enum class Type : uint8_t {
+    kScrollText,  // Replace the scrolling message with `text`
+    kStaticText,  // Show `text` without scrolling
+    // Controls, from here through kEnable (see PendingControls)
+    kTextColor,   // `value` is 0xRRGGBB
+    kBrightness,  // `value` is 0-255
+    kSpeed,       // `value` is milliseconds per frame
+    kEnable,      // `value` is zero to blank the display
+    kConfigMode,  // Give the whole display to `text` until reboot
+    kZoneText,    // `text` for the zone whose index is the top byte of `value`
+    kZoneValue,   // The same, but the low 24 bits of `value` (signed)
+    kBatch,       // Carry out all of `batch` before the next frame
+    kStop,        // Stop drawing for good, so something else can
+  };
+
+  Type type;
+  uint32_t value = 0;
+  std::string *text = nullptr;
+  std::vector<RenderCommand> *batch = nullptr;
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_RENDER_COMMAND_H_
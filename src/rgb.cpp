@@ -0,0 +1,52 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rgb.h"
+
+#include <stdint.h>
+
+namespace led_marquee {
+
+Rgb HsvToRgb(uint8_t hue, uint8_t saturation, uint8_t value) {
+  if (saturation == 0) return Rgb{value, value, value};
+
+  // Six regions of 43 hue steps each
+  const unsigned region = hue / 43u;
+  const unsigned remainder = (hue - region * 43u) * 6u;
+
+  const unsigned v = value;
+  const unsigned s = saturation;
+  const auto p = static_cast<uint8_t>((v * (255u - s)) >> 8);
+  const auto q =
+      static_cast<uint8_t>((v * (255u - ((s * remainder) >> 8))) >> 8);
+  const auto t =
+      static_cast<uint8_t>((v * (255u - ((s * (255u - remainder)) >> 8))) >> 8);
+
+  switch (region) {
+    case 0:
+      return Rgb{value, t, p};
+    case 1:
+      return Rgb{q, value, p};
+    case 2:
+      return Rgb{p, value, t};
+    case 3:
+      return Rgb{p, q, value};
+    case 4:
+      return Rgb{t, p, value};
+    default:
+      return Rgb{value, p, q};
+  }
+}
+
+}  // namespace led_marquee
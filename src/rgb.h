@@ -0,0 +1,48 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_RGB_H_
+#define LED_MARQUEE_RGB_H_
+
+#include <stdint.h>
+
+namespace led_marquee {
+
+// One pixel. The layout matches FastLED's CRGB, but this doesn't depend on
+// FastLED so that rendering can be built and tested on the host.
+struct Rgb {
+  uint8_t r = 0;
+  uint8_t g = 0;
+  uint8_t b = 0;
+
+  constexpr bool operator==(const Rgb &other) const {
+    return r == other.r && g == other.g && b == other.b;
+  }
+  constexpr bool operator!=(const Rgb &other) const {
+    return !(*this == other);
+  }
+};
+static_assert(sizeof(Rgb) == 3, "Rgb must be packed like CRGB");
+
+constexpr Rgb kBlack{0, 0, 0};
+
+// Converts an 8-bit HSV triple to RGB, with hue covering the full circle in
+// 0..255.
+Rgb HsvToRgb(uint8_t hue, uint8_t saturation, uint8_t value);
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_RGB_H_
@@ -0,0 +1,340 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "text_renderer.h"
+
+#include <assert.h>
+#include <limits.h>
+#include <markup.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+
+#include "font.h"
+#include "framebuffer.h"
+#include "rgb.h"
+
+namespace led_marquee {
+
+void TextRenderer::SetFont(const uint8_t *font_data) {
+  font_ = Font(font_data);
+
+  // Rasterized columns are 16 bits
+  assert(font_.Height() <= 16);
+}
+
+void TextRenderer::Init(Framebuffer &frame, int width, int height, int x,
+                        int y) {
+  frame_ = &frame;
+  width_ = width;
+  height_ = height;
+  x_ = x;
+  y_ = y;
+}
+
+void TextRenderer::SetText(std::string_view text) {
+  text_.assign(text);
+  Reset();
+
+  // May be a little high because of ops, but saves regrowing
+  columns_.reserve(text.size() * static_cast<std::size_t>(font_.Advance()));
+}
+
+void TextRenderer::DrawStaticText(std::string_view text) {
+  text_.assign(text);
+  RedrawStaticText();
+}
+
+void TextRenderer::RedrawStaticText() {
+  Reset();
+  Rasterize(width_);
+  if (frame_) Draw(0);
+}
+
+bool TextRenderer::FieldsChanged() {
+  if (!fields_) return false;
+
+  for (const auto &field : field_values_) {
+    uint32_t version;
+    fields_->Get(field.spec, &version);
+    if (version != field.version) return true;
+  }
+  return false;
+}
+
+int TextRenderer::TextWidth() {
+  Rasterize(INT_MAX);
+  return RasterizedWidth();
+}
+
+int TextRenderer::UpdateText() {
+  if (!frame_) return -1;
+
+  // One more column than is visible, to pick up any ops right at the edge
+  Rasterize(offset_ + width_ + 1);
+  Draw(offset_);
+  return offset_++ < RasterizedWidth() ? 0 : -1;
+}
+
+int TextRenderer::ColumnsLeft() {
+  return std::max(TextWidth() + 1 - offset_, 0);
+}
+
+bool TextRenderer::TakeCue(Cue &cue) {
+  if (next_cue_ >= cues_.size() || cues_[next_cue_].column > drawn_ + width_) {
+    return false;
+  }
+  cue = cues_[next_cue_++];
+  return true;
+}
+
+void TextRenderer::Redraw() {
+  if (frame_) Draw(drawn_);
+}
+
+void TextRenderer::RedrawBetween(uint8_t fraction) {
+  if (frame_) Draw(drawn_, fraction);
+}
+
+TextRenderer::StyleRun &TextRenderer::NewRun() {
+  // Back to back ops change the same run
+  if (runs_.back().column != RasterizedWidth()) {
+    runs_.push_back(runs_.back());
+    runs_.back().column = RasterizedWidth();
+  }
+  return runs_.back();
+}
+
+void TextRenderer::Reset() {
+  text_pos_ = 0;
+  offset_ = 0;
+
+  columns_.clear();
+  runs_.clear();
+  runs_.push_back({0, false, {}, false});
+  cues_.clear();
+  next_cue_ = 0;
+  field_values_.clear();
+  has_blink_ = false;
+  drawn_ = 0;
+}
+
+void TextRenderer::Rasterize(int min_columns) {
+  const std::string_view text = text_;
+
+  while (text_pos_ < text.size() && RasterizedWidth() < min_columns) {
+    if (!markup::IsOp(text[text_pos_])) {
+      AppendGlyph(static_cast<uint8_t>(text[text_pos_++]));
+      continue;
+    }
+
+    const std::size_t op_size = markup::OpSize(text.substr(text_pos_));
+    if (op_size == 0) {
+      // Cut off, so that's the end
+      text_pos_ = text.size();
+      break;
+    }
+    const auto arg = [&](std::size_t n) {
+      return static_cast<uint8_t>(text[text_pos_ + 1 + n]);
+    };
+
+    switch (text[text_pos_]) {
+      case markup::kColor:
+        NewRun().escaped = true;
+        runs_.back().color = Rgb{arg(0), arg(1), arg(2)};
+        break;
+      case markup::kHsv:
+        NewRun().escaped = true;
+        runs_.back().color = HsvToRgb(arg(0), arg(1), arg(2));
+        break;
+      case markup::kBlink:
+        NewRun().blink = arg(0) != 0;
+        has_blink_ |= runs_.back().blink;
+        break;
+      case markup::kSpeed:
+      case markup::kPause:
+        cues_.push_back({RasterizedWidth(),
+                         text[text_pos_] == markup::kSpeed ? Cue::Type::kSpeed
+                                                           : Cue::Type::kPause,
+                         static_cast<uint16_t>(arg(0) << 8 | arg(1))});
+        break;
+      case markup::kIcon:
+        if (arg(0) < markup::kNumIcons) {
+          const auto &icon = markup::kIcons[arg(0)];
+          for (int gx = 0; gx < icon.width; gx++) {
+            columns_.push_back(icon.columns[gx]);
+          }
+          columns_.push_back(0);
+        }
+        break;
+      case markup::kField: {
+        const auto spec = text.substr(text_pos_ + 2, op_size - 2);
+        uint32_t version = 0;
+        if (fields_) {
+          for (char c : fields_->Get(spec, &version)) {
+            AppendGlyph(static_cast<uint8_t>(c));
+          }
+        }
+        field_values_.push_back({spec, version});
+        break;
+      }
+    }
+    text_pos_ += op_size;
+  }
+}
+
+int TextRenderer::Measure(std::string_view text,
+                          std::vector<Cue> &cues) const {
+  int width = 0;
+  std::size_t pos = 0;
+
+  while (pos < text.size()) {
+    if (!markup::IsOp(text[pos])) {
+      width += font_.Advance();
+      pos++;
+      continue;
+    }
+
+    const std::size_t op_size = markup::OpSize(text.substr(pos));
+    if (op_size == 0) break;
+    const auto arg = [&](std::size_t n) {
+      return static_cast<uint8_t>(text[pos + 1 + n]);
+    };
+
+    switch (text[pos]) {
+      case markup::kSpeed:
+      case markup::kPause:
+        cues.push_back({width,
+                        text[pos] == markup::kSpeed ? Cue::Type::kSpeed
+                                                    : Cue::Type::kPause,
+                        static_cast<uint16_t>(arg(0) << 8 | arg(1))});
+        break;
+      case markup::kIcon:
+        if (arg(0) < markup::kNumIcons) {
+          width += markup::kIcons[arg(0)].width + 1;
+        }
+        break;
+      case markup::kField:
+        width += static_cast<int>(op_size - 2) * font_.Advance();
+        break;
+    }
+    pos += op_size;
+  }
+  return width;
+}
+
+void TextRenderer::AppendGlyph(uint8_t c) {
+  for (int gx = 0; gx < font_.Width(); gx++) {
+    columns_.push_back(static_cast<Column>(font_.Column(c, gx)));
+  }
+  // Gap between characters
+  columns_.push_back(0);
+}
+
+void TextRenderer::Draw(int start, uint8_t fraction) {
+  const int text_width = RasterizedWidth();
+  drawn_ = start;
+
+  // Find the style in effect at the start of the window
+  auto run = std::upper_bound(
+      runs_.begin(), runs_.end(), start,
+      [](int column, const StyleRun &run) { return column < run.column; });
+  --run;
+
+  // The bits and color of a column, with the run that covers it
+  const auto style = [&](int column, auto &run, Column &bits) {
+    while (run + 1 != runs_.end() && (run + 1)->column <= column) ++run;
+    bits = column < text_width ? columns_[static_cast<std::size_t>(column)] : 0;
+    if (run->blink && !blink_visible_) bits = 0;
+    return run->escaped ? run->color : color_;
+  };
+
+  if (fraction == 0) {
+    for (int x = 0; x < width_; x++) {
+      Column bits;
+      const Rgb color = style(start + x, run, bits);
+      DrawColumn(x, bits, color);
+    }
+    return;
+  }
+
+  auto next_run = run;
+  for (int x = 0; x < width_; x++) {
+    Column bits, next_bits;
+    const Rgb color = style(start + x, run, bits);
+    const Rgb next_color = style(start + x + 1, next_run, next_bits);
+    DrawBlendedColumn(x, bits, color, next_bits, next_color, 256u - fraction);
+  }
+}
+
+void TextRenderer::DrawColumn(int x, Column bits, Rgb color) {
+  const int frame_x = x_ + x;
+  if (frame_x < 0 || frame_x >= frame_->Width()) return;
+
+  // Rows of the region that are inside the frame
+  const int y_begin = std::max(y_, 0);
+  const int y_end = std::min(y_ + height_, frame_->Height());
+  if (y_begin >= y_end) return;
+
+  Rgb *pixels = &frame_->At(frame_x, 0);
+  if (background_ == Background::kErase) {
+    std::fill(pixels + y_begin, pixels + y_end, kBlack);
+  }
+
+  // Glyph rows run top down, and the framebuffer's origin is at the bottom
+  const int top = y_ + height_ - 1;
+  for (unsigned lit = bits; lit; lit &= lit - 1) {
+    const int y = top - __builtin_ctz(lit);
+    if (y >= y_begin && y < y_end) pixels[y] = color;
+  }
+}
+
+void TextRenderer::DrawBlendedColumn(int x, Column bits, Rgb color,
+                                     Column next_bits, Rgb next_color,
+                                     unsigned weight) {
+  const int frame_x = x_ + x;
+  if (frame_x < 0 || frame_x >= frame_->Width()) return;
+
+  const int y_begin = std::max(y_, 0);
+  const int y_end = std::min(y_ + height_, frame_->Height());
+  if (y_begin >= y_end) return;
+
+  Rgb *pixels = &frame_->At(frame_x, 0);
+  if (background_ == Background::kErase) {
+    std::fill(pixels + y_begin, pixels + y_end, kBlack);
+  }
+
+  const auto mix = [weight](uint8_t a, uint8_t b, bool lit, bool next_lit) {
+    const unsigned value =
+        (lit ? a * weight : 0u) + (next_lit ? b * (256u - weight) : 0u);
+    return static_cast<uint8_t>(value >> 8);
+  };
+
+  const int top = y_ + height_ - 1;
+  for (unsigned lit = bits | next_bits; lit; lit &= lit - 1) {
+    const int row = __builtin_ctz(lit);
+    const int y = top - row;
+    if (y < y_begin || y >= y_end) continue;
+
+    const bool on = bits >> row & 1;
+    const bool next_on = next_bits >> row & 1;
+    pixels[y] = Rgb{mix(color.r, next_color.r, on, next_on),
+                    mix(color.g, next_color.g, on, next_on),
+                    mix(color.b, next_color.b, on, next_on)};
+  }
+}
+
+}  // namespace led_marquee
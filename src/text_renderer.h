@@ -0,0 +1,187 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_TEXT_RENDERER_H_
+#define LED_MARQUEE_TEXT_RENDERER_H_
+
+#include <markup.h>
+#include <stdint.h>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fields.h"
+#include "font.h"
+#include "framebuffer.h"
+#include "rgb.h"
+
+namespace led_marquee {
+
+// Draws text into a rectangular region of a Framebuffer. This covers the parts
+// of cLEDText that the marquee uses, scrolling left one column at a time in a
+// single text color, plus the markup ops produced by Interpolate().
+//
+// Unlike cLEDText, the text is rasterized once, into one bit mask per column
+// plus the points where the style changes. Each update is then just a copy of
+// the visible window into the framebuffer. Ops that are about timing, not
+// drawing, become cues for whoever is doing the scrolling.
+//
+// Rasterizing happens just ahead of the window, so dynamic fields get their
+// values as they're about to scroll into view.
+class TextRenderer {
+ public:
+  enum class Background { kErase, kLeave };
+
+  // Followed by three bytes of red, green and blue
+  static constexpr char kRgbEscape = markup::kColor;
+
+  // A point in the text where the scrolling should change
+  struct Cue {
+    enum class Type : uint8_t {
+      kSpeed,  // `value` is milliseconds per column, or 0 for the default
+      kPause,  // `value` is milliseconds
+    };
+
+    int column;
+    Type type;
+    uint16_t value;
+  };
+
+  void SetFont(const uint8_t *font_data);
+  uint8_t FontWidth() const { return font_.Width(); };
+  uint8_t FontHeight() const { return font_.Height(); };
+  int FontAdvance() const { return font_.Advance(); };
+
+  void Init(Framebuffer &frame, int width, int height, int x, int y);
+
+  void SetColor(Rgb color) { color_ = color; };
+  void SetBackground(Background background) { background_ = background; };
+  // Where dynamic fields get their values. Without it, they're left blank.
+  void SetFields(Fields *fields) { fields_ = fields; };
+
+  // Sets the text and rewinds to its start
+  void SetText(std::string_view text);
+
+  // Draws the start of the text in place, without scrolling. Only the part
+  // that fits is rasterized.
+  void DrawStaticText(std::string_view text);
+
+  // Whether any fields that have been drawn would look different now
+  bool FieldsChanged();
+  // Rasterizes and draws the static text again, e.g. after FieldsChanged()
+  void RedrawStaticText();
+
+  // Width of the whole text in columns. Fields that haven't been reached yet
+  // are filled in with their current values.
+  int TextWidth();
+
+  // Width of `text` in columns, and its cues, worked out from the font alone.
+  // Field values aren't known until they're drawn, so each one is taken to be
+  // as long as its spec. Doesn't touch the current text, so it's safe to call
+  // from any task once the font is set.
+  int Measure(std::string_view text, std::vector<Cue> &cues) const;
+
+  // Draws the visible part of the text, then scrolls one column to the left.
+  // Like cLEDText, returns -1 once the end of the text has gone by.
+  int UpdateText();
+  // Calls to UpdateText() left, including the one that returns -1
+  int ColumnsLeft();
+
+  // Gets the next cue that the last UpdateText() brought into view, if any.
+  // A cue is reached once everything before it is on the display.
+  bool TakeCue(Cue &cue);
+
+  // Blinking text is only drawn while this is on. Takes effect the next time
+  // the text is drawn.
+  void SetBlinkVisible(bool visible) { blink_visible_ = visible; };
+  bool HasBlink() const { return has_blink_; };
+
+  // Draws the same window again, e.g. for blinking
+  void Redraw();
+  // Draws the same window, but `fraction` / 256 of the way to the next
+  // column, with each column blended into the one after it. For scrolling
+  // more smoothly than a column at a time.
+  void RedrawBetween(uint8_t fraction);
+
+ private:
+  // One bit per row, bit 0 being the top
+  using Column = uint16_t;
+
+  // Style from `column` onwards. The color is either the text color or from
+  // an op.
+  struct StyleRun {
+    int column;
+    bool escaped;
+    Rgb color;
+    bool blink;
+  };
+
+  // A field that has been filled in
+  struct FieldValue {
+    std::string_view spec;
+    uint32_t version;
+  };
+
+  // Starts over at the beginning of the text
+  void Reset();
+  // Rasterizes more of the text, until there are at least `min_columns`
+  // columns or it's all done
+  void Rasterize(int min_columns);
+  void AppendGlyph(uint8_t c);
+
+  int RasterizedWidth() const { return static_cast<int>(columns_.size()); };
+
+  // Starts a new style at the current column, based on the one before
+  StyleRun &NewRun();
+
+  // Draws the window starting at text column `start`, plus `fraction` / 256
+  // of a column
+  void Draw(int start, uint8_t fraction = 0);
+  void DrawColumn(int x, Column bits, Rgb color);
+  // Draws `bits` at `weight` / 256 of `color`, plus `next_bits` at the rest
+  // of `next_color`
+  void DrawBlendedColumn(int x, Column bits, Rgb color, Column next_bits,
+                         Rgb next_color, unsigned weight);
+
+  Framebuffer *frame_ = nullptr;
+  Font font_;
+  Rgb color_{0xff, 0xff, 0xff};
+  Background background_ = Background::kErase;
+  Fields *fields_ = nullptr;
+
+  // The text, and how much of it has been rasterized
+  std::string text_;
+  std::size_t text_pos_ = 0;
+
+  std::vector<Column> columns_;
+  std::vector<StyleRun> runs_{{0, false, {}, false}};
+  std::vector<Cue> cues_;
+  std::size_t next_cue_ = 0;
+  std::vector<FieldValue> field_values_;
+  bool has_blink_ = false;
+  bool blink_visible_ = true;
+  int offset_ = 0;
+  // Where the window started on the last draw
+  int drawn_ = 0;
+
+  int width_ = 0, height_ = 0, x_ = 0, y_ = 0;
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_TEXT_RENDERER_H_
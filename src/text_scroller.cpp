@@ -14,23 +14,24 @@
 
 #include "text_scroller.h"
 
-#include <FastLED.h>
-#include <FontClassic.h>
-#include <LEDText.h>
-#include <string.h>
+#include <stdint.h>
 
+#include <algorithm>
 #include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "debug_serial.h"
 #include "display_manager.h"
+#include "text_renderer.h"
 
 namespace led_marquee {
 
 TextScroller::TextScroller(DisplayManager &display_manager,
                            const uint8_t *font_data)
     : display_manager_(display_manager) {
-  led_text_.SetFont(font_data);
-  led_text_.SetTextColrOptions(COLR_RGB | COLR_SINGLE, 0xff, 0xff, 0xff);
+  renderer_.SetFont(font_data);
 }
 
 void TextScroller::Init(const int width, const int height, const int x,
@@ -40,22 +41,22 @@ void TextScroller::Init(const int width, const int height, const int x,
   x_ = x;
   y_ = y;
 
-  display_manager_.InitLedText(led_text_, width, height, x, y);
+  display_manager_.InitLedText(renderer_, width, height, x, y);
 
-  std::size_t num_spaces = 1 + width / (led_text_.FontWidth() + 1);
-  char *buf = new char[num_spaces + 1];
-  memset(buf, ' ', num_spaces);
-  buf[num_spaces] = '\0';
+  auto num_spaces =
+      static_cast<std::size_t>(1 + width / (renderer_.FontWidth() + 1));
+  spaces_.assign(num_spaces, ' ');
 
-  spaces_ = buf;
+  estimate_width_ = width;
+  estimate_lead_ = static_cast<int>(num_spaces) * renderer_.FontAdvance();
 }
 
 void TextScroller::SetColorRgb(uint8_t r, uint8_t g, uint8_t b) {
-  led_text_.SetTextColrOptions(COLR_RGB | COLR_SINGLE, r, g, b);
+  renderer_.SetColor(Rgb{r, g, b});
 }
 
-void TextScroller::SetBackgroundMode(uint16_t options, uint8_t dimming) {
-  led_text_.SetBackgroundMode(options, dimming);
+void TextScroller::SetBackgroundMode(TextRenderer::Background background) {
+  renderer_.SetBackground(background);
 }
 
 void TextScroller::EnableScrolling() {
@@ -64,11 +65,11 @@ void TextScroller::EnableScrolling() {
   }
 }
 
-void TextScroller::ShowStaticText(const String &text) {
+void TextScroller::ShowStaticText(std::string_view text) {
   scroll_mode_ = ScrollMode::kStatic;
 
   auto len = text.length();
-  if (len > max_length_) {
+  if (len > static_cast<std::size_t>(max_length_)) {
     debug_print("WARNING: Message truncated (");
     debug_print(len);
     debug_print(" > ");
@@ -76,23 +77,20 @@ void TextScroller::ShowStaticText(const String &text) {
     debug_println(")");
   }
 
-  String message = text.substring(0, max_length_);
+  auto message = text.substr(0, static_cast<std::size_t>(max_length_));
 
+  ResetMarkup();
   if (display_manager_.IsEnabled()) {
     EraseArea();
-    led_text_.SetScrollDirection(SCROLL_LEFT);
-    led_text_.SetText((unsigned char *)message.c_str(), message.length());
-    led_text_.UpdateText();
-    FastLED.show();
+    renderer_.DrawStaticText(message);
   }
 }
 
-// `text` must be NULL-terminated
-void TextScroller::ShowScrollText(const String &text) {
+void TextScroller::ShowScrollText(std::string_view text) {
   scroll_mode_ = ScrollMode::kScrolling;
 
   auto len = text.length();
-  if (len > max_length_) {
+  if (len > static_cast<std::size_t>(max_length_)) {
     debug_print("WARNING: Message truncated (");
     debug_print(len);
     debug_print(" > ");
@@ -100,26 +98,134 @@ void TextScroller::ShowScrollText(const String &text) {
     debug_println(")");
   }
 
-  scroll_buf_ = spaces_ + text.substring(0, max_length_);
+  scroll_buf_ = spaces_;
+  scroll_buf_.append(text.substr(0, static_cast<std::size_t>(max_length_)));
 
   ShowScrollText();
 }
 
 void TextScroller::ShowScrollText() {
-  led_text_.SetScrollDirection(SCROLL_LEFT);
-  led_text_.SetText((unsigned char *)scroll_buf_.c_str(), scroll_buf_.length());
+  ResetMarkup();
+  renderer_.SetText(scroll_buf_);
+}
+
+void TextScroller::ResetMarkup() {
+  speed_override_ = 0;
+  hold_frames_ = 0;
+  elapsed_ms_ = 0;
+  blink_visible_ = true;
+  renderer_.SetBlinkVisible(true);
+}
+
+void TextScroller::UpdateBlink() {
+  elapsed_ms_ += static_cast<uint32_t>(FrameTime());
+  const bool visible = elapsed_ms_ / kBlinkMs % 2 == 0;
+  if (visible == blink_visible_) return;
+
+  blink_visible_ = visible;
+  renderer_.SetBlinkVisible(visible);
 }
 
 void TextScroller::EraseArea() {
   display_manager_.FillArea(x_, y_, width_, height_);
 }
 
+void TextScroller::Redraw() {
+  EraseArea();
+  if (scroll_mode_ == ScrollMode::kStatic) {
+    renderer_.RedrawStaticText();
+  } else {
+    renderer_.Redraw();
+  }
+}
+
+void TextScroller::DrawBetween(uint8_t fraction) {
+  if (scroll_mode_ == ScrollMode::kStatic || hold_frames_ > 0) return;
+  if (display_manager_.IsEnabled()) renderer_.RedrawBetween(fraction);
+}
+
+int TextScroller::RemainingMs() {
+  if (scroll_mode_ == ScrollMode::kStatic) return 0;
+  return (renderer_.ColumnsLeft() + hold_frames_) * FrameTime();
+}
+
+ScrollTime TextScroller::Estimate(std::string_view text) const {
+  std::vector<TextRenderer::Cue> cues;
+  // The message starts off the right edge, after spaces_. It's over on the
+  // frame after the last column goes by, which is when the next one starts.
+  // Init() can change both of these from the render task, so they're
+  // snapshots; each one is consistent on its own.
+  const int lead = estimate_lead_;
+  const int width = estimate_width_;
+  const int frames =
+      lead + 1 +
+      renderer_.Measure(text.substr(0, static_cast<std::size_t>(max_length_)),
+                        cues);
+
+  ScrollTime time;
+  int frame = 0;
+  int speed = 0;
+  const auto run_to = [&](int end) {
+    if (end <= frame) return;
+    if (speed) {
+      time.fixed_ms += (end - frame) * speed;
+    } else {
+      time.frames += end - frame;
+    }
+    frame = end;
+  };
+
+  // Cues take effect once they reach the right edge
+  for (const auto &cue : cues) {
+    run_to(std::min(lead + cue.column - width, frames));
+    if (cue.type == TextRenderer::Cue::Type::kSpeed) {
+      speed = cue.value;
+    } else {
+      time.fixed_ms += cue.value;
+    }
+  }
+  run_to(frames);
+
+  return time;
+}
+
 bool TextScroller::Animate() {
-  if (scroll_mode_ == TextScroller::ScrollMode::kScrolling) {
-    return led_text_.UpdateText() != -1;
+  const bool was_visible = blink_visible_;
+  if (renderer_.HasBlink()) UpdateBlink();
+
+  if (scroll_mode_ == TextScroller::ScrollMode::kStatic) {
+    // Static text stays up, so fields in it are kept up to date
+    if ((blink_visible_ != was_visible || renderer_.FieldsChanged()) &&
+        display_manager_.IsEnabled()) {
+      EraseArea();
+      renderer_.RedrawStaticText();
+    }
+    return true;
+  }
+
+  if (hold_frames_ > 0) {
+    hold_frames_--;
+    if (blink_visible_ != was_visible) renderer_.Redraw();
+    return true;
+  }
+
+  const bool more = renderer_.UpdateText() != -1;
+
+  TextRenderer::Cue cue;
+  while (renderer_.TakeCue(cue)) {
+    switch (cue.type) {
+      case TextRenderer::Cue::Type::kSpeed:
+        speed_override_ = cue.value;
+        break;
+      case TextRenderer::Cue::Type::kPause:
+        // Round up, so short pauses still happen
+        hold_frames_ = (cue.value + FrameTime() - 1) / FrameTime();
+        break;
+    }
   }
 
-  return true;
+  // A pause at the very end still happens before the message is over
+  return more || hold_frames_ > 0;
 }
 
 }  // namespace led_marquee
\ No newline at end of file
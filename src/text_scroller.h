@@ -17,50 +17,122 @@
 #ifndef LED_MARQUEE_TEXT_SCROLLER_H_
 #define LED_MARQUEE_TEXT_SCROLLER_H_
 
-#include <LEDText.h>
 #include <stdint.h>
 
+#include <atomic>
 #include <memory>
+#include <string>
+#include <string_view>
 
 #include "display_manager.h"
+#include "fields.h"
+#include "text_renderer.h"
 
 namespace led_marquee {
 
+// How long a message takes to scroll by. Most of it goes at whatever the
+// speed is when it's shown, but markup can set the speed of the rest, and add
+// pauses.
+struct ScrollTime {
+  // Frames at the usual speed
+  int frames = 0;
+  // Time taken by everything else
+  int fixed_ms = 0;
+
+  int Ms(int speed) const { return frames * speed + fixed_ms; };
+
+  ScrollTime &operator+=(const ScrollTime &other) {
+    frames += other.frames;
+    fixed_ms += other.fixed_ms;
+    return *this;
+  };
+  ScrollTime &operator-=(const ScrollTime &other) {
+    frames -= other.frames;
+    fixed_ms -= other.fixed_ms;
+    return *this;
+  };
+};
+
 class TextScroller {
  public:
   TextScroller(DisplayManager &display_manager, const uint8_t *font_data);
 
-  TextScroller(const TextScroller &other) = default;
-  TextScroller &operator=(const TextScroller &other) = default;
+  // Not copyable
+  TextScroller(const TextScroller &other) = delete;
+  TextScroller &operator=(const TextScroller &other) = delete;
 
   void Init(const int width, const int height, const int x, const int y);
 
-  uint8_t FontHeight() { return led_text_.FontHeight(); };
+  uint8_t FontHeight() { return renderer_.FontHeight(); };
 
   void SetColorRgb(uint8_t r, uint8_t g, uint8_t b);
-  void SetBackgroundMode(uint16_t options, uint8_t dimming = 0x00);
+  void SetBackgroundMode(TextRenderer::Background background);
+  void SetFields(Fields *fields) { renderer_.SetFields(fields); };
   void SetMaxLength(const int max_length) { max_length_ = max_length; };
   void EnableScrolling();
+  bool IsScrolling() const { return scroll_mode_ == ScrollMode::kScrolling; };
 
-  void ShowStaticText(const String &);
-  void ShowScrollText(const String &);
+  // Milliseconds per frame, i.e. per column of scrolling. Markup in the
+  // message can change it; FrameTime() is what's in effect now.
+  void SetSpeed(int ms) { speed_ = ms; };
+  int FrameTime() const { return speed_override_ ? speed_override_ : speed_; };
+
+  // Draws `text` without scrolling. Like anything else that's drawn, it's
+  // on the display after the next DisplayManager::Show().
+  void ShowStaticText(std::string_view);
+  void ShowScrollText(std::string_view);
   void ShowScrollText();
 
   void EraseArea();
+  // Draws the text where it was, e.g. after something else drew over it
+  void Redraw();
 
+  // Moves on by one frame. Returns false once the end of a scrolling message
+  // has gone by.
   bool Animate();
+  // Draws scrolling text `fraction` / 256 of the way to the next frame (see
+  // TextRenderer::RedrawBetween()). Static text, and text that's holding for
+  // a pause, stays put.
+  void DrawBetween(uint8_t fraction);
+
+  // Roughly how long until the message has gone by, at the speed it's going
+  // now. Static text stays up until it's replaced, so that's 0.
+  int RemainingMs();
+
+  // How long `text` would take to scroll by, without rasterizing it (see
+  // TextRenderer::Measure()). Safe to call from any task, even while Init()
+  // is moving the scroller.
+  ScrollTime Estimate(std::string_view text) const;
 
  private:
   enum class ScrollMode { kStatic, kScrolling };
 
+  // Blinking text is on for this long, then off for the same
+  static constexpr int kBlinkMs = 500;
+
+  // Resets what the markup in the last message changed
+  void ResetMarkup();
+  void UpdateBlink();
+
   DisplayManager &display_manager_;
-  cLEDText led_text_;
+  TextRenderer renderer_;
   ScrollMode scroll_mode_ = ScrollMode::kScrolling;
 
-  String spaces_, scroll_buf_;
+  std::string spaces_, scroll_buf_;
 
   int width_, height_, x_, y_;
   int max_length_ = 1024;
+  // What Estimate() needs from Init(), for other tasks to read: the width,
+  // and the columns of spaces a message starts with
+  std::atomic<int> estimate_width_{0};
+  std::atomic<int> estimate_lead_{0};
+
+  int speed_ = 40;
+  int speed_override_ = 0;
+  // Frames left to hold still for a pause
+  int hold_frames_ = 0;
+  uint32_t elapsed_ms_ = 0;
+  bool blink_visible_ = true;
 };
 
 }  // namespace led_marquee
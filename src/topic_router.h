@@ -0,0 +1,87 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_TOPIC_ROUTER_H_
+#define LED_MARQUEE_TOPIC_ROUTER_H_
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace led_marquee {
+
+// 32-bit FNV-1a
+constexpr uint32_t TopicHash(std::string_view topic) {
+  uint32_t hash = 2166136261u;
+  for (char c : topic) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+  }
+  return hash;
+}
+
+// Finds the handler for an MQTT topic. Topics are added once, when the
+// subscriptions are set up, and looking one up after that doesn't allocate:
+// it's a hash of the topic, then a string compare against routes with the
+// same hash.
+template <typename Handler, std::size_t Capacity>
+class TopicRouter {
+ public:
+  // Returns false if there's no room left
+  bool Add(std::string_view topic, Handler handler) {
+    if (size_ == Capacity) return false;
+    routes_[size_++] = {TopicHash(topic), std::string(topic), handler};
+    return true;
+  }
+
+  // Adds `prefix` followed by `suffix`
+  bool Add(std::string_view prefix, std::string_view suffix, Handler handler) {
+    std::string topic;
+    topic.reserve(prefix.size() + suffix.size());
+    topic.append(prefix).append(suffix);
+    return Add(topic, handler);
+  }
+
+  void Clear() { size_ = 0; };
+
+  // The handler for `topic`, or nullptr if there isn't one
+  const Handler *Find(std::string_view topic) const {
+    const uint32_t hash = TopicHash(topic);
+    for (std::size_t i = 0; i < size_; i++) {
+      if (routes_[i].hash == hash && routes_[i].topic == topic) {
+        return &routes_[i].handler;
+      }
+    }
+    return nullptr;
+  }
+
+  std::size_t size() const { return size_; };
+
+ private:
+  struct Route {
+    uint32_t hash;
+    std::string topic;
+    Handler handler;
+  };
+
+  Route routes_[Capacity];
+  std::size_t size_ = 0;
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_TOPIC_ROUTER_H_
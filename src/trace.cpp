@@ -0,0 +1,97 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "trace.h"
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace led_marquee {
+
+namespace {
+
+struct EventInfo {
+  char phase;
+  const char *name;
+  const char *arg_name;
+};
+
+// In TraceEvent order
+constexpr EventInfo kEvents[] = {
+    {'B', "frame", ""},
+    {'E', "frame", ""},
+    {'B', "show", ""},
+    {'E', "show", ""},
+    {'i', "late stream frame", "behind_ticks"},
+    {'i', "command", "type"},
+    {'i', "message", "length"},
+    {'C', "queue depth", "messages"},
+    {'i', "stream frame", ""},
+    {'i', "mqtt message", "length"},
+    {'i', "websocket message", "length"},
+    {'B', "preview", ""},
+    {'E', "preview", "bytes"},
+    {'i', "late zones", "missed_updates"},
+};
+static_assert(sizeof(kEvents) / sizeof(kEvents[0]) ==
+                  static_cast<std::size_t>(TraceEvent::kCount),
+              "Every TraceEvent needs a name");
+
+// In TraceThread order
+constexpr const char *kThreads[] = {"render", "loop", "core 0", "core 1"};
+static_assert(sizeof(kThreads) / sizeof(kThreads[0]) ==
+                  static_cast<std::size_t>(TraceThread::kCount),
+              "Every TraceThread needs a name");
+
+void Append32(std::vector<uint8_t> &out, uint32_t value) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    out.push_back(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+void AppendString(std::vector<uint8_t> &out, const char *s) {
+  do {
+    out.push_back(static_cast<uint8_t>(*s));
+  } while (*s++);
+}
+
+}  // namespace
+
+void WriteTrace(const std::vector<TraceRecord> &records, uint32_t now_us,
+                std::vector<uint8_t> &out) {
+  out.clear();
+  out.insert(out.end(), {'L', 'M', 'T', 'R', 1,
+                         static_cast<uint8_t>(TraceEvent::kCount),
+                         static_cast<uint8_t>(TraceThread::kCount), 0});
+  Append32(out, now_us);
+
+  for (const auto &event : kEvents) {
+    out.push_back(static_cast<uint8_t>(event.phase));
+    AppendString(out, event.name);
+    AppendString(out, event.arg_name);
+  }
+  for (const char *thread : kThreads) AppendString(out, thread);
+
+  Append32(out, static_cast<uint32_t>(records.size()));
+  for (const auto &record : records) {
+    Append32(out, record.time_us);
+    out.insert(out.end(), {static_cast<uint8_t>(record.event),
+                           static_cast<uint8_t>(record.thread), 0, 0});
+    Append32(out, record.arg);
+  }
+}
+
+}  // namespace led_marquee
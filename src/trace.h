@@ -0,0 +1,149 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_TRACE_H_
+#define LED_MARQUEE_TRACE_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace led_marquee {
+
+// What happened. Begin and end events bracket something on one thread; see
+// trace.cpp for their names, and what their argument means.
+enum class TraceEvent : uint8_t {
+  kFrameBegin,
+  kFrameEnd,
+  kShowBegin,
+  kShowEnd,
+  kLateStreamFrame,
+  kCommand,
+  kMessage,
+  kQueueDepth,
+  kStreamFrame,
+  kMqttMessage,
+  kWebSocketMessage,
+  kPreviewBegin,
+  kPreviewEnd,
+  kLateZones,
+  kCount
+};
+
+// Where it happened. Tasks other than the render task and loop() are told
+// apart by core.
+enum class TraceThread : uint8_t { kRender, kLoop, kCore0, kCore1, kCount };
+
+struct TraceRecord {
+  uint32_t time_us;
+  TraceEvent event;
+  TraceThread thread;
+  uint32_t arg;
+};
+
+// The last Capacity trace records, kept in RAM to be dumped on request (see
+// WriteTrace()). Any task can record without locking or waiting: each record
+// takes the next slot, and the oldest is overwritten. Records being written
+// while they're read are left out, rather than read half done.
+template <std::size_t Capacity>
+class TraceRing {
+  static_assert((Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of 2");
+
+ public:
+  TraceRing() = default;
+
+  // Not copyable
+  TraceRing(const TraceRing &) = delete;
+  TraceRing &operator=(const TraceRing &) = delete;
+
+  void Record(uint32_t time_us, TraceEvent event, TraceThread thread,
+              uint32_t arg = 0) {
+    const uint32_t n = next_.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = slots_[n % Capacity];
+
+    // Odd while it's being written, then even and unique to this record
+    slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.time_us.store(time_us, std::memory_order_relaxed);
+    slot.info.store(static_cast<uint32_t>(event) |
+                        static_cast<uint32_t>(thread) << 8,
+                    std::memory_order_relaxed);
+    slot.arg.store(arg, std::memory_order_relaxed);
+    slot.sequence.store(2 * n + 2, std::memory_order_release);
+  }
+
+  // Copies what's in the ring into `records`, oldest first
+  void Snapshot(std::vector<TraceRecord> &records) const {
+    const uint32_t end = next_.load(std::memory_order_acquire);
+    const uint32_t count = std::min<uint32_t>(end, Capacity);
+    records.clear();
+    records.reserve(count);
+
+    for (uint32_t n = end - count; n != end; n++) {
+      const Slot &slot = slots_[n % Capacity];
+      const uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+      // Not done yet, or already replaced by a newer one
+      if (sequence != 2 * n + 2) continue;
+
+      const uint32_t info = slot.info.load(std::memory_order_relaxed);
+      const TraceRecord record = {
+          slot.time_us.load(std::memory_order_relaxed),
+          static_cast<TraceEvent>(info & 0xff),
+          static_cast<TraceThread>(info >> 8 & 0xff),
+          slot.arg.load(std::memory_order_relaxed)};
+      std::atomic_thread_fence(std::memory_order_acquire);
+      // Replaced while it was being copied
+      if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+
+      records.push_back(record);
+    }
+  }
+
+  // Total records since startup, including overwritten ones
+  uint32_t recorded() const { return next_.load(std::memory_order_relaxed); };
+
+ private:
+  struct Slot {
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint32_t> time_us{0};
+    std::atomic<uint32_t> info{0};
+    std::atomic<uint32_t> arg{0};
+  };
+
+  Slot slots_[Capacity];
+  std::atomic<uint32_t> next_{0};
+};
+
+// Writes `records` in the dump format that scripts/decode_trace.py reads,
+// all little endian:
+//
+//   "LMTR", version (1), number of events, number of threads, 0
+//   now_us: 32 bits, when the dump was taken
+//   for each TraceEvent: phase ('B', 'E', 'i' or 'C'), then its name and
+//     the name of its argument, each NUL terminated
+//   for each TraceThread: its name, NUL terminated
+//   number of records: 32 bits
+//   for each record: time_us (32 bits), event, thread, 0, 0, arg (32 bits)
+void WriteTrace(const std::vector<TraceRecord> &records, uint32_t now_us,
+                std::vector<uint8_t> &out);
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_TRACE_H_
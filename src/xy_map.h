@@ -0,0 +1,79 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_XY_MAP_H_
+#define LED_MARQUEE_XY_MAP_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <cstddef>
+
+namespace led_marquee {
+
+// How the LEDs are strung through the matrix, as seen from the front with data
+// coming in at the bottom left. These are the same as cLEDMatrix's
+// MatrixType_t, for a single block.
+enum class MatrixType : uint8_t {
+  kHorizontal,
+  kVertical,
+  kHorizontalZigzag,
+  kVerticalZigzag,
+};
+
+// Position along the LED string of pixel (x, y), where (0, 0) is the bottom
+// left. Set `reverse` if the data comes in on the right instead.
+constexpr int XyIndex(MatrixType type, int width, int height, bool reverse,
+                      int x, int y) {
+  if (reverse) x = width - 1 - x;
+
+  switch (type) {
+    case MatrixType::kHorizontal:
+      return y * width + x;
+    case MatrixType::kVertical:
+      return x * height + y;
+    case MatrixType::kHorizontalZigzag:
+      return y % 2 ? (y + 1) * width - 1 - x : y * width + x;
+    case MatrixType::kVerticalZigzag:
+      return x % 2 ? (x + 1) * height - 1 - y : x * height + y;
+  }
+  return 0;
+}
+
+// XyIndex() for every pixel, worked out at compile time. It's in the same
+// order as Framebuffer::data(), so mapping a frame onto the LEDs is one lookup
+// per pixel.
+template <MatrixType Type, int Width, int Height, bool Reverse>
+struct XyTable {
+  static_assert(Width * Height <= 0x10000, "Too many LEDs for the table");
+
+  static constexpr std::array<uint16_t, Width * Height> Build() {
+    std::array<uint16_t, Width * Height> index{};
+    for (int x = 0; x < Width; x++) {
+      for (int y = 0; y < Height; y++) {
+        index[static_cast<std::size_t>(x * Height + y)] = static_cast<uint16_t>(
+            XyIndex(Type, Width, Height, Reverse, x, y));
+      }
+    }
+    return index;
+  };
+
+  static constexpr std::array<uint16_t, Width * Height> kIndex = Build();
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_XY_MAP_H_
@@ -0,0 +1,129 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "zone_layout.h"
+
+#include <interpolate.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "display_manager.h"
+#include "fields.h"
+#include "zones.h"
+
+namespace led_marquee {
+
+ZoneLayout::ZoneLayout(DisplayManager &display_manager, const ZoneSpec *specs,
+                       std::size_t count, const uint8_t *default_font,
+                       Fields *fields, Fields::WallClock wall_clock)
+    : display_manager_(display_manager) {
+  zones_.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    const ZoneSpec &spec = specs[i];
+    const uint8_t *font = spec.font ? spec.font : default_font;
+    const auto interval = [&](uint32_t default_ms) {
+      return spec.interval_ms ? spec.interval_ms : default_ms;
+    };
+
+    std::unique_ptr<Zone> zone;
+    if (spec.width > 0 && spec.height > 0) {
+      switch (spec.type) {
+        case ZoneType::kScroller: {
+          auto scroller = std::make_unique<ScrollerZone>(
+              display_manager, font, spec.x, spec.y, spec.width, spec.height);
+          scroller->scroller().SetColorRgb(spec.color.r, spec.color.g,
+                                           spec.color.b);
+          scroller->scroller().SetFields(fields);
+          scroller->SetBlendInterval(spec.interval_ms);
+          if (!scroller_) scroller_ = scroller.get();
+          zone = std::move(scroller);
+          break;
+        }
+        case ZoneType::kText:
+          zone = std::make_unique<TextZone>(
+              display_manager, font, spec.x, spec.y, spec.width, spec.height,
+              Interpolate(spec.text), spec.color, fields,
+              interval(kTextIntervalMs));
+          break;
+        case ZoneType::kClock:
+          zone = std::make_unique<ClockZone>(
+              display_manager, font, spec.x, spec.y, spec.width, spec.height,
+              *spec.text ? spec.text : kClockFormat, spec.color, wall_clock,
+              interval(kClockIntervalMs));
+          break;
+        case ZoneType::kIcon:
+          zone = std::make_unique<TextZone>(
+              display_manager, font, spec.x, spec.y, spec.width, spec.height,
+              Interpolate(std::string("{icon:") + spec.text + "}"),
+              spec.color, nullptr, 0);
+          break;
+        case ZoneType::kBar:
+          zone = std::make_unique<BarZone>(display_manager, spec.x, spec.y,
+                                           spec.width, spec.height,
+                                           spec.color);
+          break;
+      }
+    }
+    zones_.push_back(std::move(zone));
+  }
+
+  if (!scroller_) {
+    auto scroller = std::make_unique<ScrollerZone>(display_manager,
+                                                   default_font, 0, 0, 0, 0);
+    scroller->scroller().SetFields(fields);
+    scroller_ = scroller.get();
+    spare_scroller_ = std::move(scroller);
+  }
+}
+
+bool ZoneLayout::Update(uint32_t now_ms) {
+  bool drew = false;
+  for (auto &zone : zones_) {
+    if (!zone) continue;
+    uint32_t missed;
+    drew |= zone->Update(now_ms, missed);
+    late_updates_ += missed;
+  }
+  return drew;
+}
+
+uint32_t ZoneLayout::MsUntilDue(uint32_t now_ms) {
+  uint32_t until = UINT32_MAX;
+  for (auto &zone : zones_) {
+    if (zone) until = std::min(until, zone->MsUntilDue(now_ms));
+  }
+  return until;
+}
+
+void ZoneLayout::Redraw() {
+  for (auto &zone : zones_) {
+    if (zone) zone->Redraw();
+  }
+}
+
+void ZoneLayout::FullScreen() {
+  for (auto &zone : zones_) {
+    if (zone.get() != scroller_) zone.reset();
+  }
+  if (spare_scroller_) zones_.push_back(std::move(spare_scroller_));
+  scroller_->Resize(0, 0, display_manager_.GetWidth(),
+                    display_manager_.GetHeight());
+  display_manager_.Clear();
+}
+
+}  // namespace led_marquee
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_ZONE_LAYOUT_H_
+#define LED_MARQUEE_ZONE_LAYOUT_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "display_manager.h"
+#include "fields.h"
+#include "rgb.h"
+#include "text_scroller.h"
+#include "zones.h"
+
+namespace led_marquee {
+
+enum class ZoneType : uint8_t {
+  kScroller,  // Messages; the first one gets the message queue
+  kText,      // `text`, with markup, e.g. a status line
+  kClock,     // The time, with `text` as the strftime() format
+  kIcon,      // The markup::kIcons icon named by `text`
+  kBar,       // A bar graph, set to 0-100 with SetValue()
+};
+
+// Where a zone goes, and what's in it. The origin is at the bottom left, as
+// for DisplayManager::FillArea().
+struct ZoneSpec {
+  ZoneType type;
+  int x, y, width, height;
+  // nullptr for the layout's default font
+  const uint8_t *font = nullptr;
+  // Milliseconds between updates, or 0 for the zone's own default. Scrollers
+  // go at the scroll speed regardless; for them, this is how often to draw
+  // in between columns, blending one into the next (see ScrollerZone).
+  uint32_t interval_ms = 0;
+  const char *text = "";
+  // For clocks, ClockZone::kCycleColors steps through the hues
+  Rgb color{255, 255, 255};
+};
+
+// Splits the display into rectangular zones (see Zone), each of which draws
+// only when it's due or has changed. The zones are set up in
+// marquee_config.h.
+class ZoneLayout {
+ public:
+  // Updates for text zones that don't say otherwise, to keep their fields
+  // current
+  static constexpr uint32_t kTextIntervalMs = 250;
+  static constexpr uint32_t kClockIntervalMs = 1000;
+  static constexpr const char *kClockFormat = "%l:%M:%S";
+
+  // Zones with no area are left out, but still count for zone(), so that
+  // indexes match `specs`. If there's no scroller, text() goes to a spare one
+  // that isn't shown until FullScreen().
+  ZoneLayout(DisplayManager &display_manager, const ZoneSpec *specs,
+             std::size_t count, const uint8_t *default_font, Fields *fields,
+             Fields::WallClock wall_clock);
+
+  // Not copyable or movable
+  ZoneLayout(const ZoneLayout &) = delete;
+  ZoneLayout &operator=(const ZoneLayout &) = delete;
+
+  // The (first) scroller
+  TextScroller &text() { return scroller_->scroller(); };
+  ScrollerZone &scroller() { return *scroller_; };
+
+  // The zone made from specs[index], or nullptr if there isn't one
+  Zone *zone(std::size_t index) {
+    return index < zones_.size() ? zones_[index].get() : nullptr;
+  };
+
+  // Updates every zone that's due or has changed. Returns true if anything
+  // was drawn, and the frame needs showing.
+  bool Update(uint32_t now_ms);
+
+  // Milliseconds until Update() has something to do
+  uint32_t MsUntilDue(uint32_t now_ms);
+
+  // Draws every zone again, e.g. after something else drew over them
+  void Redraw();
+
+  // Gives the whole display to the scroller, for good. This is intended for
+  // things like entering configuration mode: there is no returning to normal
+  // without rebooting.
+  void FullScreen();
+
+  // Zone updates that were skipped because they were running behind, one for
+  // each interval gone by. Safe to read from any task.
+  uint32_t late_updates() const { return late_updates_; };
+
+ private:
+  DisplayManager &display_manager_;
+  std::vector<std::unique_ptr<Zone>> zones_;
+  ScrollerZone *scroller_ = nullptr;
+  // The scroller when `zones_` doesn't have one
+  std::unique_ptr<ScrollerZone> spare_scroller_;
+  std::atomic<uint32_t> late_updates_{0};
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_ZONE_LAYOUT_H_
@@ -0,0 +1,206 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "zones.h"
+
+#include <stdint.h>
+#include <time.h>
+
+#include <algorithm>
+#include <string_view>
+
+#include "display_manager.h"
+#include "fields.h"
+#include "rgb.h"
+
+namespace led_marquee {
+
+bool Zone::Update(uint32_t now_ms, uint32_t &missed) {
+  missed = 0;
+  if (!scheduled_) {
+    next_ms_ = now_ms;
+    scheduled_ = true;
+  }
+
+  const uint32_t interval = IntervalMs();
+  const bool due =
+      interval > 0 && static_cast<int32_t>(now_ms - next_ms_) >= 0;
+  if (!due && !invalidated_) return false;
+
+  if (due) {
+    next_ms_ += interval;
+    // Too far behind to catch up, so skip what's gone by and start again
+    // from now
+    if (static_cast<int32_t>(now_ms - next_ms_) >= 0) {
+      missed = (now_ms - next_ms_) / interval + 1;
+      next_ms_ = now_ms + interval;
+    }
+  }
+  const bool invalidated = invalidated_;
+  invalidated_ = false;
+  return Draw(now_ms, due && !invalidated);
+}
+
+uint32_t Zone::MsUntilDue(uint32_t now_ms) {
+  if (!scheduled_ || invalidated_) return 0;
+
+  const uint32_t interval = IntervalMs();
+  if (interval == 0) return UINT32_MAX;
+  const int32_t until = static_cast<int32_t>(next_ms_ - now_ms);
+  return until > 0 ? static_cast<uint32_t>(until) : 0;
+}
+
+ScrollerZone::ScrollerZone(DisplayManager &display_manager,
+                           const uint8_t *font, int x, int y, int width,
+                           int height)
+    : Zone(display_manager, x, y, width, height),
+      scroller_(display_manager, font) {
+  scroller_.Init(width, height, x, y);
+}
+
+void ScrollerZone::Resize(int x, int y, int width, int height) {
+  x_ = x;
+  y_ = y;
+  width_ = width;
+  height_ = height;
+  scroller_.Init(width, height, x, y);
+  Redraw();
+}
+
+uint32_t ScrollerZone::IntervalMs() const {
+  const auto frame_ms = static_cast<uint32_t>(scroller_.FrameTime());
+  return blend_ms_ ? std::min(blend_ms_, frame_ms) : frame_ms;
+}
+
+bool ScrollerZone::Draw(uint32_t now_ms, bool due) {
+  if (!due) {
+    // Time spent not being drawn isn't caught up on
+    last_ms_ = now_ms;
+    owed_ms_ = 0;
+    scroller_.Redraw();
+    return true;
+  }
+
+  owed_ms_ = std::min(owed_ms_ + (now_ms - last_ms_), kMaxCatchUpMs);
+  last_ms_ = now_ms;
+
+  // Markup can change the speed as it goes
+  bool drew = false;
+  for (auto frame_ms = static_cast<uint32_t>(scroller_.FrameTime());
+       owed_ms_ >= frame_ms;
+       frame_ms = static_cast<uint32_t>(scroller_.FrameTime())) {
+    owed_ms_ -= frame_ms;
+    if (animator_) {
+      animator_(scroller_);
+    } else {
+      scroller_.Animate();
+    }
+    drew = true;
+  }
+
+  if (blend_ms_ && owed_ms_ > 0) {
+    const auto frame_ms = static_cast<uint32_t>(scroller_.FrameTime());
+    scroller_.DrawBetween(static_cast<uint8_t>(owed_ms_ * 256 / frame_ms));
+    drew = true;
+  }
+  return drew;
+}
+
+TextZone::TextZone(DisplayManager &display_manager, const uint8_t *font,
+                   int x, int y, int width, int height, std::string_view text,
+                   Rgb color, Fields *fields, uint32_t interval_ms)
+    : Zone(display_manager, x, y, width, height),
+      text_(text),
+      interval_ms_(interval_ms) {
+  renderer_.SetFont(font);
+  renderer_.SetColor(color);
+  renderer_.SetFields(fields);
+  display_manager.InitLedText(renderer_, width, height, x, y);
+}
+
+void TextZone::SetText(std::string_view text) {
+  text_.assign(text);
+  Invalidate();
+}
+
+bool TextZone::Draw(uint32_t now_ms, bool due) {
+  bool changed = !due;
+  if (due && renderer_.FieldsChanged()) changed = true;
+
+  const bool visible = !renderer_.HasBlink() || now_ms / kBlinkMs % 2 == 0;
+  if (visible != blink_visible_) {
+    blink_visible_ = visible;
+    renderer_.SetBlinkVisible(visible);
+    changed = true;
+  }
+
+  if (!changed || !display_manager_.IsEnabled()) return false;
+  EraseArea();
+  renderer_.DrawStaticText(text_);
+  return true;
+}
+
+ClockZone::ClockZone(DisplayManager &display_manager, const uint8_t *font,
+                     int x, int y, int width, int height,
+                     std::string_view format, Rgb color,
+                     Fields::WallClock wall_clock, uint32_t interval_ms)
+    : Zone(display_manager, x, y, width, height),
+      clock_(display_manager, font),
+      format_(format),
+      wall_clock_(wall_clock),
+      interval_ms_(interval_ms),
+      cycle_colors_(color == kCycleColors) {
+  clock_.Init(width, height, x, y);
+  if (cycle_colors_) {
+    clock_.SetColorHsv(hue_, 0xff, 0xff);
+  } else {
+    clock_.SetColor(color);
+  }
+}
+
+bool ClockZone::Draw(uint32_t /*now_ms*/, bool due) {
+  if (!due) {
+    clock_.Redraw();
+  } else if (cycle_colors_) {
+    clock_.SetColorHsv(++hue_, 0xff, 0xff);
+  }
+
+  const time_t now = wall_clock_();
+  tm local;
+  localtime_r(&now, &local);
+  char text[40];
+  strftime(text, sizeof(text), format_.c_str(), &local);
+
+  return clock_.SetText(text);
+}
+
+BarZone::BarZone(DisplayManager &display_manager, int x, int y, int width,
+                 int height, Rgb color)
+    : Zone(display_manager, x, y, width, height), color_(color) {}
+
+void BarZone::SetValue(int value) {
+  value_ = std::clamp(value, 0, 100);
+  Invalidate();
+}
+
+bool BarZone::Draw(uint32_t /*now_ms*/, bool /*due*/) {
+  if (!display_manager_.IsEnabled()) return false;
+
+  const int filled = (width_ * value_ + 50) / 100;
+  display_manager_.FillArea(x_, y_, filled, height_, color_);
+  display_manager_.FillArea(x_ + filled, y_, width_ - filled, height_);
+  return true;
+}
+
+}  // namespace led_marquee
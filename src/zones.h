@@ -0,0 +1,206 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LED_MARQUEE_ZONES_H_
+#define LED_MARQUEE_ZONES_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#include <string>
+#include <string_view>
+
+#include "clock.h"
+#include "display_manager.h"
+#include "fields.h"
+#include "rgb.h"
+#include "text_renderer.h"
+#include "text_scroller.h"
+
+namespace led_marquee {
+
+// A rectangle of the display that draws itself, at its own pace. Each zone
+// is due every IntervalMs(), and also draws after it's changed; in between,
+// its pixels are left alone. See ZoneLayout.
+class Zone {
+ public:
+  Zone(DisplayManager &display_manager, int x, int y, int width, int height)
+      : display_manager_(display_manager),
+        x_(x),
+        y_(y),
+        width_(width),
+        height_(height){};
+  virtual ~Zone() = default;
+
+  // Not copyable
+  Zone(const Zone &) = delete;
+  Zone &operator=(const Zone &) = delete;
+
+  // Draws the zone if it's due or has changed. Returns true if it drew
+  // anything. `missed` is set to how many updates came due and went while
+  // it was running behind, i.e. were skipped.
+  bool Update(uint32_t now_ms, uint32_t &missed);
+
+  // Milliseconds until Update() has something to do
+  uint32_t MsUntilDue(uint32_t now_ms);
+
+  // Draws it all again on the next Update(), and starts the schedule over
+  // from there, e.g. after something else had the display for a while
+  void Redraw() {
+    invalidated_ = true;
+    scheduled_ = false;
+  };
+
+  // Content from outside, e.g. MQTT. What it means is up to the zone; most
+  // ignore one or the other.
+  virtual void SetText(std::string_view /*text*/){};
+  virtual void SetValue(int /*value*/){};
+  // The zone's text, if it has any
+  virtual std::string_view Text() const { return {}; };
+
+ protected:
+  // Time between updates, or 0 to only draw when the zone has changed
+  virtual uint32_t IntervalMs() const = 0;
+
+  // Draws the zone. If it isn't `due`, it was invalidated, and needs drawing
+  // in full. Returns false if nothing changed.
+  virtual bool Draw(uint32_t now_ms, bool due) = 0;
+
+  // Draws it all again on the next Update(), e.g. after it's changed
+  void Invalidate() { invalidated_ = true; };
+
+  void EraseArea() { display_manager_.FillArea(x_, y_, width_, height_); };
+
+  DisplayManager &display_manager_;
+  int x_, y_, width_, height_;
+
+ private:
+  bool scheduled_ = false;
+  bool invalidated_ = true;
+  uint32_t next_ms_ = 0;
+};
+
+// Where messages scroll by. Where the text is comes from the time that's
+// gone by, at the scroll speed, so updates that are late catch up rather
+// than slowing the message down.
+class ScrollerZone : public Zone {
+ public:
+  // Most time to catch up on at once. After a longer stall, the message is
+  // that much behind.
+  static constexpr uint32_t kMaxCatchUpMs = 250;
+
+  // Called for each frame instead of TextScroller::Animate(), e.g. to move
+  // on to the next message at the end of one
+  using Animator = void (*)(TextScroller &scroller);
+
+  ScrollerZone(DisplayManager &display_manager, const uint8_t *font, int x,
+               int y, int width, int height);
+
+  TextScroller &scroller() { return scroller_; };
+  void SetAnimator(Animator animator) { animator_ = animator; };
+  // Draws this often between columns, blending each column into the next,
+  // when that's more often than the scroll speed. 0 to only draw whole
+  // columns.
+  void SetBlendInterval(uint32_t interval_ms) { blend_ms_ = interval_ms; };
+
+  // Moves it somewhere else, e.g. to take over the whole display
+  void Resize(int x, int y, int width, int height);
+
+ protected:
+  uint32_t IntervalMs() const override;
+  bool Draw(uint32_t now_ms, bool due) override;
+
+ private:
+  TextScroller scroller_;
+  Animator animator_ = nullptr;
+  uint32_t blend_ms_ = 0;
+  // When time was last counted, and how much of it hasn't been scrolled yet
+  uint32_t last_ms_ = 0;
+  uint32_t owed_ms_ = 0;
+};
+
+// Text that stays put, with markup, e.g. a status line from an MQTT topic
+// ({topic:...}) or an icon. Fields and blinking are kept up to date.
+class TextZone : public Zone {
+ public:
+  // Blinking text is on for this long, then off for the same
+  static constexpr uint32_t kBlinkMs = 500;
+
+  // `text` is as produced by Interpolate()
+  TextZone(DisplayManager &display_manager, const uint8_t *font, int x, int y,
+           int width, int height, std::string_view text, Rgb color,
+           Fields *fields, uint32_t interval_ms);
+
+  void SetText(std::string_view text) override;
+  std::string_view Text() const override { return text_; };
+
+ protected:
+  uint32_t IntervalMs() const override { return interval_ms_; };
+  bool Draw(uint32_t now_ms, bool due) override;
+
+ private:
+  TextRenderer renderer_;
+  std::string text_;
+  const uint32_t interval_ms_;
+  bool blink_visible_ = true;
+};
+
+// The time, formatted by strftime(). Only the characters that changed are
+// drawn again, unless the color's cycling.
+class ClockZone : public Zone {
+ public:
+  // As the color, steps through the hues, one per update. A black clock
+  // wouldn't be much use anyway.
+  static constexpr Rgb kCycleColors = kBlack;
+
+  ClockZone(DisplayManager &display_manager, const uint8_t *font, int x,
+            int y, int width, int height, std::string_view format, Rgb color,
+            Fields::WallClock wall_clock, uint32_t interval_ms);
+
+ protected:
+  uint32_t IntervalMs() const override { return interval_ms_; };
+  bool Draw(uint32_t now_ms, bool due) override;
+
+ private:
+  Clock clock_;
+  const std::string format_;
+  const Fields::WallClock wall_clock_;
+  const uint32_t interval_ms_;
+  const bool cycle_colors_;
+  uint8_t hue_ = 0;
+};
+
+// A horizontal bar, filled from the left in proportion to a value from 0 to
+// 100
+class BarZone : public Zone {
+ public:
+  BarZone(DisplayManager &display_manager, int x, int y, int width,
+          int height, Rgb color);
+
+  void SetValue(int value) override;
+
+ protected:
+  uint32_t IntervalMs() const override { return 0; };
+  bool Draw(uint32_t now_ms, bool due) override;
+
+ private:
+  const Rgb color_;
+  int value_ = 0;
+};
+
+}  // namespace led_marquee
+
+#endif  // LED_MARQUEE_ZONES_H_
@@ -0,0 +1,107 @@
+# Copyright 2022 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Plasma, rendered here and streamed to the marquee as raw pixels over DDP.
+# Needs nothing outside the standard library.
+
+import argparse
+import colorsys
+import math
+import socket
+import time
+
+DDP_PORT = 4048
+DDP_VERSION_1 = 0x40
+DDP_PUSH = 0x01
+DDP_TYPE_RGB8 = 0x0B
+DDP_DEFAULT_OUTPUT = 1
+
+
+def plasma(width, height, t):
+    """One frame as RGB bytes, in rows from the top left."""
+    pixels = bytearray()
+    for y in range(height):
+        for x in range(width):
+            v = (
+                math.sin(x / 4.0 + t)
+                + math.sin((y / 2.0 + t) / 2.0)
+                + math.sin((x + y + t * 4) / 6.0)
+            )
+            r, g, b = colorsys.hsv_to_rgb((v / 6.0 + t / 10.0) % 1.0, 1.0, 1.0)
+            pixels += bytes((int(r * 255), int(g * 255), int(b * 255)))
+    return pixels
+
+
+def ddp_packets(pixels, sequence, max_data):
+    """Splits a frame into DDP packets. The last one has the push flag."""
+    for offset in range(0, len(pixels), max_data):
+        data = pixels[offset : offset + max_data]
+        last = offset + len(data) >= len(pixels)
+        header = bytes(
+            (
+                DDP_VERSION_1 | (DDP_PUSH if last else 0),
+                sequence,
+                DDP_TYPE_RGB8,
+                DDP_DEFAULT_OUTPUT,
+            )
+        )
+        header += offset.to_bytes(4, "big") + len(data).to_bytes(2, "big")
+        yield header + data
+
+
+def get_args():
+    parser = argparse.ArgumentParser(
+        description="Streams a plasma animation to a marquee."
+    )
+    parser.add_argument("--host", required=True, help="Marquee address")
+    parser.add_argument("--port", type=int, default=DDP_PORT, help="UDP port")
+    parser.add_argument("--width", type=int, default=32, help="Marquee width")
+    parser.add_argument("--height", type=int, default=8, help="Marquee height")
+    parser.add_argument("--fps", type=float, default=30, help="Frames per second")
+    parser.add_argument(
+        "--seconds", type=float, default=10, help="How long to stream for"
+    )
+    parser.add_argument(
+        "--packet_pixels",
+        type=int,
+        default=480,
+        help="Pixels per packet; frames larger than this are split",
+    )
+
+    return parser.parse_args()
+
+
+def main():
+    args = get_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    frame_time = 1.0 / args.fps
+    start = time.monotonic()
+    frame = 0
+
+    while time.monotonic() - start < args.seconds:
+        pixels = plasma(args.width, args.height, frame * frame_time)
+        # Sequence numbers go 1..15; 0 means unsequenced
+        sequence = frame % 15 + 1
+        for packet in ddp_packets(pixels, sequence, args.packet_pixels * 3):
+            sock.sendto(packet, (args.host, args.port))
+
+        frame += 1
+        time.sleep(max(0, start + frame * frame_time - time.monotonic()))
+
+    print(f"Sent {frame} frames")
+
+
+if __name__ == "__main__":
+    main()
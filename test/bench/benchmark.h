@@ -0,0 +1,120 @@
+/*
+ * Copyright 2022 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Minimal timing helpers shared by the host benchmarks. These only time
+// things, so they're kept out of the tests and run on their own, with
+// `pio test -e bench`.
+//
+// Each result is written as one line of JSON, so runs can be collected and
+// compared between releases. Results go to stdout, and are also appended to
+// the file named by the LM_BENCH_OUTPUT environment variable if it's set.
+
+#ifndef LED_MARQUEE_TEST_BENCHMARK_H_
+#define LED_MARQUEE_TEST_BENCHMARK_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace led_marquee::bench {
+
+// Extra fields to record alongside a result, e.g. {"width", 288}
+struct Param {
+  const char *name;
+  long value;
+};
+
+// Runs `fn` repeatedly for at least `min_ms`, and returns nanoseconds per call
+template <typename Fn>
+double TimePerCall(Fn &&fn, int min_ms = 100) {
+  using Clock = std::chrono::steady_clock;
+
+  // Warm up caches and let anything lazy happen first
+  for (int i = 0; i < 16; i++) fn();
+
+  long calls = 0;
+  const auto start = Clock::now();
+  auto elapsed = Clock::duration::zero();
+  do {
+    for (int i = 0; i < 64; i++) fn();
+    calls += 64;
+    elapsed = Clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(min_ms));
+
+  return static_cast<double>(
+             std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                 .count()) /
+         static_cast<double>(calls);
+}
+
+inline void Report(const char *benchmark, const std::vector<Param> &params,
+                   double ns_per_call) {
+  std::string line = std::string("{\"benchmark\": \"") + benchmark + "\"";
+  for (const auto &param : params) {
+    line += std::string(", \"") + param.name +
+            "\": " + std::to_string(param.value);
+  }
+  char ns[32];
+  snprintf(ns, sizeof(ns), "%.1f", ns_per_call);
+  line += std::string(", \"ns_per_call\": ") + ns + "}\n";
+
+  fputs(line.c_str(), stdout);
+  if (const char *path = getenv("LM_BENCH_OUTPUT")) {
+    if (FILE *f = fopen(path, "a")) {
+      fputs(line.c_str(), f);
+      fclose(f);
+    }
+  }
+}
+
+// Keeps the compiler from optimizing away a result
+template <typename T>
+inline void DoNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// A 5x7 font in LEDText format covering printable ASCII, with arbitrary but
+// dense glyphs. The real fonts live in the LEDText library, which isn't built
+// for the host; for timing, only the size and density matter.
+inline std::vector<uint8_t> MakeFont(uint8_t width = 5, uint8_t height = 7) {
+  std::vector<uint8_t> font{width, height, 0x20, 0x7e};
+  const int row_bytes = (width + 7) / 8;
+  uint32_t seed = 0x12345678;
+  for (int c = 0x20; c <= 0x7e; c++) {
+    for (int i = 0; i < height * row_bytes; i++) {
+      seed = seed * 1664525u + 1013904223u;
+      font.push_back(c == ' ' ? 0 : static_cast<uint8_t>(seed >> 24));
+    }
+  }
+  return font;
+}
+
+// Printable text of the given length
+inline std::string MakeMessage(std::size_t length) {
+  static const char kWords[] = "The quick brown fox jumps over the lazy dog. ";
+  std::string message;
+  while (message.size() < length) message += kWords;
+  message.resize(length);
+  return message;
+}
+
+}  // namespace led_marquee::bench
+
+#endif  // LED_MARQUEE_TEST_BENCHMARK_H_
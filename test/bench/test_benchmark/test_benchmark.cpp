@@ -0,0 +1,222 @@
+// Per-frame rendering benchmarks. These run the same code as the device, but
+// against HostOutput, so FastLED.show() (the time spent on the wire) is not
+// included: see FastLedOutput for that part.
+
+#include <clock.h>
+#include <display_manager.h>
+#include <fields.h>
+#include <framebuffer.h>
+#include <gtest/gtest.h>
+#include <host_output.h>
+#include <rgb.h>
+#include <time.h>
+#include <xy_map.h>
+#include <zone_layout.h>
+#include <zones.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../benchmark.h"
+
+namespace bench = led_marquee::bench;
+
+// Marquee widths: one panel, one section of three panels, three sections
+const std::vector<int> kWidths = {32, 96, 288};
+// Message lengths, up to kMaxMessageLen
+const std::vector<int> kMessageLengths = {16, 128, 1024};
+
+constexpr int kHeight = 8;
+constexpr int kMaxMessageLen = 1024;
+// The default scroll speed; at this rate, the clock changes every 25 frames
+constexpr uint32_t kStepMs = 40;
+
+const std::vector<uint8_t> kFont = bench::MakeFont(5, 7);
+const std::vector<uint8_t> kClockFont = bench::MakeFont(6, 7);
+
+// What the layout sees as millis() and time(), moved along by the benchmarks
+uint32_t fake_millis = 0;
+
+uint32_t FakeMillis() { return fake_millis; }
+time_t FakeTime() { return fake_millis / 1000; }
+
+// The layout from marquee_config.h.dist: messages on the left, and a clock on
+// the right if there's room for one
+class Marquee {
+ public:
+  Marquee(int width, int clock_width)
+      : display_manager_(std::make_unique<led_marquee::HostOutput>(width,
+                                                                   kHeight),
+                         width, kHeight),
+        fields_(FakeTime, FakeMillis),
+        specs_{
+            {led_marquee::ZoneType::kScroller, 0, 0, width - clock_width,
+             kHeight},
+            {led_marquee::ZoneType::kClock, width - clock_width + 1, 0,
+             clock_width - 1, kHeight, kClockFont.data(), 1000, "%l:%M:%S"},
+        },
+        layout_(display_manager_, specs_, clock_width ? 2 : 1, kFont.data(),
+                &fields_, FakeTime) {
+    layout_.text().SetMaxLength(kMaxMessageLen);
+    // Start the message over at the end, like AnimateScroller() in main.cpp
+    layout_.scroller().SetAnimator([](led_marquee::TextScroller &text) {
+      if (!text.Animate()) text.ShowScrollText();
+    });
+  }
+
+  led_marquee::DisplayManager &display_manager() { return display_manager_; };
+  led_marquee::ZoneLayout &layout() { return layout_; };
+
+ private:
+  led_marquee::DisplayManager display_manager_;
+  led_marquee::Fields fields_;
+  led_marquee::ZoneSpec specs_[2];
+  led_marquee::ZoneLayout layout_;
+};
+
+// A one-panel marquee has no room for a clock
+int ClockWidth(int width) { return width > 32 ? 50 : 0; }
+
+TEST(RenderBenchmark, TextScrollerAnimate) {
+  for (int width : kWidths) {
+    for (int length : kMessageLengths) {
+      Marquee marquee(width, 0);
+      auto &text = marquee.layout().text();
+      text.ShowScrollText(bench::MakeMessage(static_cast<size_t>(length)));
+
+      double ns = bench::TimePerCall([&] {
+        if (!text.Animate()) text.ShowScrollText();
+      });
+      bench::Report("TextScroller::Animate",
+                    {{"width", width}, {"message_len", length}}, ns);
+      EXPECT_GT(ns, 0);
+    }
+  }
+}
+
+TEST(RenderBenchmark, ClockSetText) {
+  for (int width : kWidths) {
+    if (!ClockWidth(width)) continue;
+    int clock_width = ClockWidth(width);
+    Marquee marquee(width, clock_width);
+    led_marquee::Clock clock(marquee.display_manager(), kClockFont.data());
+    clock.Init(clock_width - 1, kHeight, width - clock_width + 1, 0);
+    int seconds = 0;
+
+    double ns = bench::TimePerCall([&] {
+      char t[40];
+      snprintf(t, sizeof(t), "%2d:%02d:%02d", 12, seconds / 60 % 60,
+               seconds % 60);
+      seconds++;
+      clock.SetText(t);
+    });
+    bench::Report("Clock::SetText", {{"width", width}}, ns);
+    EXPECT_GT(ns, 0);
+  }
+}
+
+TEST(RenderBenchmark, ShowStaticText) {
+  for (int width : kWidths) {
+    for (int length : kMessageLengths) {
+      Marquee marquee(width, 0);
+      auto &text = marquee.layout().text();
+      const auto message = bench::MakeMessage(static_cast<size_t>(length));
+
+      double ns = bench::TimePerCall([&] { text.ShowStaticText(message); });
+      bench::Report("TextScroller::ShowStaticText",
+                    {{"width", width}, {"message_len", length}}, ns);
+      EXPECT_GT(ns, 0);
+    }
+  }
+}
+
+// Same work as one scroll tick of RenderFrame() in main.cpp: update the zones
+// that are due, which advances the scroller and, once a second, the clock,
+// and show the frame if anything was drawn.
+TEST(RenderBenchmark, LoopFrame) {
+  for (int width : kWidths) {
+    for (int length : kMessageLengths) {
+      Marquee marquee(width, ClockWidth(width));
+      auto &layout = marquee.layout();
+      auto &display_manager = marquee.display_manager();
+      layout.text().ShowScrollText(
+          bench::MakeMessage(static_cast<size_t>(length)));
+
+      double ns = bench::TimePerCall([&] {
+        fake_millis += kStepMs;
+        if (layout.Update(fake_millis)) display_manager.Show();
+      });
+      bench::Report("loop", {{"width", width}, {"message_len", length}}, ns);
+      EXPECT_GT(ns, 0);
+    }
+  }
+}
+
+// Maps pixels the way cLEDMatrix does: a virtual call, bounds check and the
+// index arithmetic for every pixel.
+class ArithmeticMap {
+ public:
+  ArithmeticMap(int width, int height) : width_(width), height_(height){};
+  virtual ~ArithmeticMap() = default;
+
+  virtual int mXY(int x, int y) {
+    return led_marquee::XyIndex(led_marquee::MatrixType::kVerticalZigzag,
+                                width_, height_, true, x, y);
+  };
+  led_marquee::Rgb &At(std::vector<led_marquee::Rgb> &leds, int x, int y) {
+    if (x < 0 || x >= width_ || y < 0 || y >= height_) return out_of_bounds_;
+    return leds[static_cast<size_t>(mXY(x, y))];
+  };
+
+ private:
+  int width_, height_;
+  led_marquee::Rgb out_of_bounds_;
+};
+
+// Copying one frame onto the LEDs, as FastLedOutput::Show() does before
+// sending it
+template <int width>
+void BenchmarkMapping() {
+  led_marquee::Framebuffer frame(width, kHeight);
+  frame.FillArea(0, 0, width / 2, kHeight, {1, 2, 3});
+  std::vector<led_marquee::Rgb> leds(frame.size());
+  auto map = std::make_unique<ArithmeticMap>(width, kHeight);
+
+  double ns = bench::TimePerCall([&] {
+    for (int x = 0; x < width; x++) {
+      for (int y = 0; y < kHeight; y++) map->At(leds, x, y) = frame.At(x, y);
+    }
+    bench::DoNotOptimize(leds);
+  });
+  bench::Report("MapFrame", {{"width", width}, {"table", 0}}, ns);
+  EXPECT_GT(ns, 0);
+
+  const auto &table = led_marquee::XyTable<
+      led_marquee::MatrixType::kVerticalZigzag, width, kHeight, true>::kIndex;
+  ns = bench::TimePerCall([&] {
+    const led_marquee::Rgb *pixels = frame.data();
+    for (size_t i = 0; i < frame.size(); i++) leds[table[i]] = pixels[i];
+    bench::DoNotOptimize(leds);
+  });
+  bench::Report("MapFrame", {{"width", width}, {"table", 1}}, ns);
+  EXPECT_GT(ns, 0);
+}
+
+TEST(RenderBenchmark, MapFrame) {
+  BenchmarkMapping<32>();
+  BenchmarkMapping<96>();
+  BenchmarkMapping<288>();
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <interpolate.h>
+
+#include <string>
+#include <vector>
+
+#include "../benchmark.h"
+
+namespace bench = led_marquee::bench;
+
+// Plain text, and text with a color change every 16 characters
+std::string MakeInput(std::size_t length, bool escapes) {
+  std::string input = bench::MakeMessage(length);
+  for (char &c : input) {
+    if (c == '{') c = '(';
+  }
+  if (escapes) {
+    for (std::size_t i = 0; i + 9 <= input.size(); i += 16) {
+      input.replace(i, 9, "{#12ab34}");
+    }
+  }
+  return input;
+}
+
+TEST(InterpolateBenchmark, Interpolate) {
+  for (int length : {16, 128, 1024}) {
+    for (bool escapes : {false, true}) {
+      const std::string input =
+          MakeInput(static_cast<std::size_t>(length), escapes);
+      std::vector<char> buffer(input.size());
+
+      double ns = bench::TimePerCall([&] {
+        bench::DoNotOptimize(led_marquee::Interpolate(input));
+      });
+      bench::Report("Interpolate",
+                    {{"message_len", length},
+                     {"escapes", escapes},
+                     {"buffer", 0}},
+                    ns);
+      EXPECT_GT(ns, 0);
+
+      ns = bench::TimePerCall([&] {
+        bench::DoNotOptimize(
+            led_marquee::Interpolate(input, buffer.data(), buffer.size()));
+        bench::DoNotOptimize(buffer);
+      });
+      bench::Report("Interpolate",
+                    {{"message_len", length},
+                     {"escapes", escapes},
+                     {"buffer", 1}},
+                    ns);
+      EXPECT_GT(ns, 0);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
@@ -0,0 +1,135 @@
+#include <asset_manifest.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using led_marquee::AssetManifest;
+
+namespace {
+
+// The project, where `pio test` runs from
+std::string ProjectDir() {
+  const char *dir = getenv("MARQUEE_PROJECT_DIR");
+  return dir ? dir : ".";
+}
+
+bool ReadFile(const std::string &path, std::string &contents) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  contents = buffer.str();
+  return true;
+}
+
+// Size of the partition called `name` in the partition table
+std::size_t PartitionSize(const std::string &table, const std::string &name) {
+  std::istringstream lines(table);
+  for (std::string line; std::getline(lines, line);) {
+    if (line.rfind(name + ",", 0) != 0) continue;
+
+    // Name, Type, SubType, Offset, Size
+    std::istringstream fields(line);
+    std::string field;
+    for (int i = 0; i < 5; i++) std::getline(fields, field, ',');
+    return std::strtoul(field.c_str(), nullptr, 0);
+  }
+  return 0;
+}
+
+// Roughly what a file takes up on SPIFFS: an index page, plus 256 byte pages
+// each with a 5 byte header
+std::size_t SpiffsFootprint(std::size_t size) {
+  constexpr std::size_t kPage = 256, kPageData = kPage - 5;
+  return kPage + (size + kPageData - 1) / kPageData * kPage;
+}
+
+}  // namespace
+
+TEST(AssetManifestTest, Parses) {
+  AssetManifest manifest;
+  ASSERT_TRUE(manifest.Parse(
+      "/css/style.css 6dbd7088cdcc94c2 786 504\n"
+      "/index.html e08ddb80793818bd 2001 907\n"));
+
+  ASSERT_EQ(manifest.assets().size(), 2u);
+  const auto *asset = manifest.Find("/index.html");
+  ASSERT_NE(asset, nullptr);
+  EXPECT_EQ(asset->etag, "e08ddb80793818bd");
+  EXPECT_EQ(asset->size, 2001u);
+  EXPECT_EQ(asset->stored_size, 907u);
+
+  EXPECT_EQ(manifest.Find("/index"), nullptr);
+  EXPECT_EQ(manifest.Find("/"), nullptr);
+}
+
+TEST(AssetManifestTest, RejectsMalformedLines) {
+  AssetManifest manifest;
+  ASSERT_TRUE(manifest.Parse("/index.html e08d 2001 907"));
+  EXPECT_FALSE(manifest.empty());
+
+  for (const char *text :
+       {"/index.html e08d 2001", "index.html e08d 2001 907",
+        "/index.html e08d 2001 907 1", "/index.html e08d x 9",
+        "/a.js 1 2 3\n/index.html  2001 907"}) {
+    EXPECT_FALSE(manifest.Parse(text)) << text;
+    EXPECT_TRUE(manifest.empty()) << text;
+  }
+}
+
+// Checks what scripts/gzip_www.py built against the spiffs partition. Only
+// runs once it's been built, which any pio command does.
+TEST(AssetManifestTest, BuiltAssetsFit) {
+  const std::string data_dir = ProjectDir() + "/.pio/data";
+  std::string text;
+  if (!ReadFile(data_dir + "/www.manifest", text)) {
+    GTEST_SKIP() << "No assets built in " << data_dir;
+  }
+
+  AssetManifest manifest;
+  ASSERT_TRUE(manifest.Parse(text));
+  ASSERT_FALSE(manifest.empty());
+
+  std::size_t size = 0, stored_size = 0;
+  std::size_t footprint = SpiffsFootprint(text.size());
+  for (const auto &asset : manifest.assets()) {
+    // Stored compressed, or as it is
+    std::string stored;
+    ASSERT_TRUE(ReadFile(data_dir + "/www" + asset.path + ".gz", stored) ||
+                ReadFile(data_dir + "/www" + asset.path, stored))
+        << asset.path;
+    EXPECT_EQ(stored.size(), asset.stored_size) << asset.path;
+
+    // SPIFFS names, including the directory, are at most 31 characters
+    EXPECT_LE(("/www" + asset.path + ".gz").size(), 31u) << asset.path;
+
+    size += asset.size;
+    stored_size += asset.stored_size;
+    footprint += SpiffsFootprint(asset.stored_size);
+  }
+  EXPECT_LT(stored_size, size);
+
+  std::string table;
+  ASSERT_TRUE(ReadFile(ProjectDir() + "/partition_custom.csv", table));
+  const std::size_t partition = PartitionSize(table, "spiffs");
+  ASSERT_GT(partition, 0u);
+
+  // SPIFFS keeps a couple of 4K blocks free for garbage collection
+  EXPECT_LE(footprint, partition - 2 * 4096);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
@@ -0,0 +1,179 @@
+#include <display_manager.h>
+#include <fields.h>
+#include <framebuffer.h>
+#include <gtest/gtest.h>
+#include <host_output.h>
+#include <stdlib.h>
+#include <text_renderer.h>
+#include <text_scroller.h>
+#include <time.h>
+
+#include <memory>
+#include <string>
+
+using namespace std::string_literals;
+
+namespace {
+
+time_t fake_time = 0;
+uint32_t fake_millis = 0;
+
+time_t FakeTime() { return fake_time; }
+uint32_t FakeMillis() { return fake_millis; }
+
+// 3x5 font with just 'H' and 'I'
+const uint8_t kTestFont[] = {
+    3,    5,    'H',  'I',                // header
+    0xa0, 0xa0, 0xe0, 0xa0, 0xa0,         // H
+    0xe0, 0x40, 0x40, 0x40, 0xe0,         // I
+};
+
+// Renders a column of the frame as a string, top row first
+std::string ColumnString(const led_marquee::Framebuffer &frame, int x) {
+  std::string s;
+  for (int y = frame.Height() - 1; y >= 0; y--) {
+    s.push_back(frame.Get(x, y) == led_marquee::kBlack ? '.' : '#');
+  }
+  return s;
+}
+
+}  // namespace
+
+TEST(FieldsTest, FormatsTime) {
+  led_marquee::Fields fields(FakeTime, FakeMillis);
+  fake_time = 3 * 3600 + 4 * 60 + 5;
+
+  EXPECT_EQ(fields.Get("time"), "03:04");
+  EXPECT_EQ(fields.Get("time:%H:%M:%S"), "03:04:05");
+  EXPECT_EQ(fields.Get("date"), "1970-01-01");
+  EXPECT_EQ(fields.Get("date:%d/%m"), "01/01");
+}
+
+TEST(FieldsTest, VersionOnlyChangesWithTheValue) {
+  led_marquee::Fields fields(FakeTime, FakeMillis);
+  fake_time = 0;
+
+  uint32_t first, second;
+  fields.Get("time", &first);
+  fake_time = 30;
+  fields.Get("time", &second);
+  EXPECT_EQ(first, second);
+
+  fake_time = 60;
+  EXPECT_EQ(fields.Get("time", &second), "00:01");
+  EXPECT_NE(first, second);
+}
+
+TEST(FieldsTest, FormatsUptime) {
+  led_marquee::Fields fields(FakeTime, FakeMillis);
+
+  fake_millis = (3600 + 2 * 60 + 3) * 1000;
+  EXPECT_EQ(fields.Get("uptime"), "01:02:03");
+  fake_millis = (2 * 86400 + 5 * 3600 + 6 * 60) * 1000;
+  EXPECT_EQ(fields.Get("uptime"), "2d 05:06");
+}
+
+TEST(FieldsTest, KeepsWatchedTopics) {
+  led_marquee::Fields fields(FakeTime, FakeMillis);
+
+  EXPECT_TRUE(fields.WatchTopic("sensors/temp"));
+  EXPECT_FALSE(fields.WatchTopic("sensors/temp"));
+  EXPECT_FALSE(fields.SetTopic("sensors/other", "1"));
+  EXPECT_EQ(fields.Get("topic:sensors/temp"), "");
+
+  EXPECT_TRUE(fields.SetTopic("sensors/temp", "21.5"));
+  EXPECT_EQ(fields.Get("topic:sensors/temp"), "21.5");
+
+  for (std::size_t i = 1; i < led_marquee::Fields::kMaxTopics; i++) {
+    EXPECT_TRUE(fields.WatchTopic("more/" + std::to_string(i)));
+  }
+  EXPECT_FALSE(fields.WatchTopic("one/too/many"));
+
+  int topics = 0;
+  fields.ForEachTopic([&](std::string_view) { topics++; });
+  EXPECT_EQ(topics, static_cast<int>(led_marquee::Fields::kMaxTopics));
+}
+
+TEST(FieldsTest, RefusesWildcardTopics) {
+  led_marquee::Fields fields(FakeTime, FakeMillis);
+
+  EXPECT_FALSE(fields.WatchTopic("#"));
+  EXPECT_FALSE(fields.WatchTopic("sensors/+/temp"));
+  EXPECT_TRUE(fields.WatchTopic("sensors/kitchen/temp"));
+}
+
+TEST(FieldsTest, VersionsAreNotReusedAfterEviction) {
+  led_marquee::Fields fields(FakeTime, FakeMillis);
+  fields.WatchTopic("status");
+  fields.SetTopic("status", "on");
+
+  uint32_t before, after;
+  fields.Get("topic:status", &before);
+  // Pushes it out of the cache
+  for (std::size_t i = 0; i < led_marquee::Fields::kMaxCached; i++) {
+    fields.Get("time:" + std::to_string(i));
+  }
+  fields.SetTopic("status", "off");
+  EXPECT_EQ(fields.Get("topic:status", &after), "off");
+  EXPECT_NE(before, after);
+}
+
+TEST(FieldsTest, FilledInAsTheyScrollIntoView) {
+  led_marquee::Fields fields(FakeTime, FakeMillis);
+  fields.WatchTopic("t");
+  fields.SetTopic("t", "H");
+
+  led_marquee::Framebuffer frame(4, 5);
+  led_marquee::TextRenderer renderer;
+  renderer.SetFont(kTestFont);
+  renderer.Init(frame, 4, 5, 0, 0);
+  renderer.SetFields(&fields);
+
+  // The field starts at column 8, off the right edge
+  renderer.SetText("II\xe6\x07topic:t"s);
+  renderer.UpdateText();
+
+  // It changes before it's shown, so the new value is what appears
+  fields.SetTopic("t", "I");
+  for (int i = 0; i < 8; i++) renderer.UpdateText();
+  EXPECT_EQ(ColumnString(frame, 0), "#...#");
+}
+
+TEST(FieldsTest, StaticTextKeepsUpToDate) {
+  led_marquee::Fields fields(FakeTime, FakeMillis);
+  fields.WatchTopic("t");
+  fields.SetTopic("t", "H");
+
+  auto output = std::make_unique<led_marquee::HostOutput>(8, 6);
+  led_marquee::DisplayManager display_manager(std::move(output), 8, 6);
+  led_marquee::TextScroller text(display_manager, kTestFont);
+  text.Init(8, 6, 0, 0);
+  auto &frame = display_manager.frame();
+  text.SetFields(&fields);
+
+  text.ShowStaticText("\xe6\x07topic:t"s);
+  EXPECT_EQ(ColumnString(frame, 0), "#####.");
+
+  text.Animate();
+  EXPECT_EQ(ColumnString(frame, 0), "#####.");
+
+  fields.SetTopic("t", "I");
+  text.Animate();
+  EXPECT_EQ(ColumnString(frame, 0), "#...#.");
+}
+
+int main(int argc, char **argv) {
+  // Times are shown in local time
+  setenv("TZ", "UTC0", 1);
+  tzset();
+
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
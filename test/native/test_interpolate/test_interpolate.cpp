@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <interpolate.h>
+#include <markup.h>
 
 #include <string>
 
@@ -39,6 +40,93 @@ TEST(InterpolateTest, InterpolatesRgb) {
       "this is \xe0\xff\x00\x00red\xe0\x00\xff\x00green\xe0\x00\x00\x{ff}blue"s);
 }
 
+TEST(InterpolateTest, CompilesMarkup) {
+  EXPECT_EQ(led_marquee::Interpolate("{red}R{blue}"),
+            "\xe0\xff\x00\x00R\xe0\x00\x00\xff"s);
+  EXPECT_EQ(led_marquee::Interpolate("{hsv:0,255,128}"),
+            "\xe5\x00\xff\x80"s);
+  EXPECT_EQ(led_marquee::Interpolate("a{speed:300}b{speed}"),
+            "a\xe1\x01\x2c" "b\xe1\x00\x00"s);
+  EXPECT_EQ(led_marquee::Interpolate("{pause:2000}"), "\xe2\x07\xd0"s);
+  EXPECT_EQ(led_marquee::Interpolate("{blink}!{/blink}"),
+            "\xe3\x01!\xe3\x00"s);
+  EXPECT_EQ(led_marquee::Interpolate("{icon:heart}"), "\xe4\x00"s);
+}
+
+TEST(InterpolateTest, CompilesFields) {
+  EXPECT_EQ(led_marquee::Interpolate("It's {time}"), "It's \xe6\x04time"s);
+  EXPECT_EQ(led_marquee::Interpolate("{time:%H:%M:%S}"),
+            "\xe6\x0dtime:%H:%M:%S"s);
+  EXPECT_EQ(led_marquee::Interpolate("{uptime}"), "\xe6\x06uptime"s);
+  EXPECT_EQ(led_marquee::Interpolate("{topic:sensors/temp}"),
+            "\xe6\x12topic:sensors/temp"s);
+  EXPECT_EQ(led_marquee::Interpolate("{topic:}"), "{topic:}");
+  EXPECT_EQ(led_marquee::Interpolate("{uptime:1}"), "{uptime:1}");
+}
+
+TEST(InterpolateTest, LeavesBadMarkupAlone) {
+  for (std::string a :
+       {"{hsv:1,2}", "{hsv:1,2,300}", "{speed:0}", "{pause:70000}",
+        "{pause:}", "{icon:nope}", "{reddish}", "{blink:1}", "{red"}) {
+    EXPECT_EQ(led_marquee::Interpolate(a), a);
+  }
+}
+
+TEST(InterpolateTest, FindsEscapesAtAnyAlignment) {
+  // The search goes a word at a time, so try the escape in every position
+  for (std::size_t prefix = 0; prefix < 12; prefix++) {
+    const std::string padding(prefix, 'x');
+    EXPECT_EQ(led_marquee::Interpolate(padding + "{#010203}y"),
+              padding + "\xe0\x01\x02\x03y");
+    EXPECT_EQ(led_marquee::Interpolate(padding + "{"), padding + "{");
+  }
+}
+
+TEST(InterpolateTest, KeepsOpsOutOfText) {
+  // Euro sign, CJK and Devanagari: UTF-8 lead bytes that are also ops
+  EXPECT_EQ(led_marquee::Interpolate("5\u20ac \u4e2d{red}\u0920!"),
+            "5? ?\xe0\xff\x00\x00?!"s);
+  // Other UTF-8, and whatever else isn't an op, goes through as it is
+  EXPECT_EQ(led_marquee::Interpolate("caf\u00e9 \xff"), "caf\u00e9 \xff");
+  EXPECT_EQ(led_marquee::Interpolate("\xe6\x7fx"), "?\x7fx");
+
+  // Also when the word-at-a-time search would skip over it
+  for (std::size_t prefix = 0; prefix < 12; prefix++) {
+    const std::string padding(prefix, 'x');
+    EXPECT_EQ(led_marquee::Interpolate(padding + "\xe2\x82\xacy"),
+              padding + "?y");
+  }
+}
+
+TEST(InterpolateTest, WritesToABuffer) {
+  const std::string a = "this is {#ff0000}red";
+  const std::string expected = "this is \xe0\xff\x00\x00red"s;
+
+  char buffer[32];
+  ASSERT_EQ(led_marquee::Interpolate(a, buffer, sizeof(buffer)),
+            expected.size());
+  EXPECT_EQ(std::string(buffer, expected.size()), expected);
+
+  // When it doesn't fit, the beginning is still there, and the length says
+  // how much room was needed
+  char small[10] = {};
+  EXPECT_EQ(led_marquee::Interpolate(a, small, sizeof(small)), expected.size());
+  EXPECT_EQ(std::string(small, sizeof(small)), expected.substr(0, 10));
+
+  EXPECT_EQ(led_marquee::Interpolate(a, nullptr, 0), expected.size());
+}
+
+TEST(MarkupTest, LeavesOutCutOffOps) {
+  const std::string a = led_marquee::Interpolate("ab{red}c{time}");
+  EXPECT_EQ(led_marquee::markup::CompleteLength(a), a.size());
+  // Cut anywhere in the color, it's left out
+  for (std::size_t length = 2; length < 6; length++) {
+    EXPECT_EQ(led_marquee::markup::CompleteLength(a.substr(0, length)), 2u);
+  }
+  EXPECT_EQ(led_marquee::markup::CompleteLength(a.substr(0, 7)), 7u);
+  EXPECT_EQ(led_marquee::markup::CompleteLength(a.substr(0, 10)), 7u);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   // if you plan to use GMock, replace the line above with
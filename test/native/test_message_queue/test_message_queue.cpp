@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <message_queue.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(MessageQueueTest, KeepsOrder) {
+  led_marquee::MessageQueue<std::string, 4> queue;
+  EXPECT_TRUE(queue.Empty());
+
+  EXPECT_TRUE(queue.Push("one"));
+  EXPECT_TRUE(queue.Push("two"));
+  EXPECT_EQ(queue.Size(), 2u);
+
+  std::string message;
+  EXPECT_TRUE(queue.Pop(message));
+  EXPECT_EQ(message, "one");
+  EXPECT_TRUE(queue.Pop(message));
+  EXPECT_EQ(message, "two");
+  EXPECT_FALSE(queue.Pop(message));
+}
+
+TEST(MessageQueueTest, DropsWhenFull) {
+  led_marquee::MessageQueue<std::string, 3> queue;
+
+  for (int i = 0; i < 5; i++) queue.Push(std::to_string(i));
+
+  EXPECT_EQ(queue.Size(), 3u);
+  EXPECT_EQ(queue.pushed(), 3u);
+  EXPECT_EQ(queue.dropped(), 2u);
+
+  // The oldest messages are the ones kept
+  std::string message;
+  queue.Pop(message);
+  EXPECT_EQ(message, "0");
+
+  // And there's room again, even after wrapping around
+  for (int i = 0; i < 10; i++) {
+    EXPECT_TRUE(queue.Push("again"));
+    EXPECT_TRUE(queue.Pop(message));
+  }
+  EXPECT_EQ(queue.Size(), 2u);
+}
+
+TEST(MessageQueueTest, HandlesConcurrentProducers) {
+  constexpr int kProducers = 4;
+  constexpr int kPerProducer = 1000;
+  led_marquee::MessageQueue<int, 8> queue;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; p++) {
+    producers.emplace_back([&queue, p] {
+      for (int i = 0; i < kPerProducer; i++) {
+        while (!queue.Push(p * kPerProducer + i)) std::this_thread::yield();
+      }
+    });
+  }
+
+  // Each producer's values must come out in order, and none can go missing
+  std::vector<int> next(kProducers, 0);
+  int received = 0;
+  while (received < kProducers * kPerProducer) {
+    int value;
+    if (!queue.Pop(value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    const int p = value / kPerProducer;
+    ASSERT_EQ(value % kPerProducer, next[p]);
+    next[p]++;
+    received++;
+  }
+
+  for (auto &producer : producers) producer.join();
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_EQ(queue.pushed(), static_cast<uint32_t>(kProducers * kPerProducer));
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <histogram.h>
+#include <metrics_writer.h>
+
+#include <cstdint>
+#include <string>
+
+using led_marquee::Histogram;
+using led_marquee::MetricsWriter;
+
+TEST(HistogramTest, CountsByBucket) {
+  Histogram<3> histogram({10, 100, 1000});
+
+  for (uint32_t value : {0, 10, 11, 100, 999, 1000, 1001, 50000}) {
+    histogram.Record(value);
+  }
+
+  // Bounds are inclusive
+  EXPECT_EQ(histogram.bucket(0), 2u);
+  EXPECT_EQ(histogram.bucket(1), 2u);
+  EXPECT_EQ(histogram.bucket(2), 2u);
+  EXPECT_EQ(histogram.count(), 8u);
+  EXPECT_EQ(histogram.sum(), 53121u);
+}
+
+TEST(MetricsWriterTest, WritesPrometheusText) {
+  MetricsWriter writer;
+  writer.AddCounter("marquee_messages_shown_total", "Messages shown.", 12);
+  writer.AddGauge("marquee_free_heap_bytes", "Free heap.", 123456);
+
+  Histogram<2> frame_time({1000, 20000});
+  frame_time.Record(500);
+  frame_time.Record(1500);
+  frame_time.Record(40000);
+  writer.AddHistogram("marquee_frame_seconds", "Time to draw a frame.",
+                      frame_time, 1e-6);
+
+  EXPECT_EQ(writer.text(),
+            "# HELP marquee_messages_shown_total Messages shown.\n"
+            "# TYPE marquee_messages_shown_total counter\n"
+            "marquee_messages_shown_total 12\n"
+            "# HELP marquee_free_heap_bytes Free heap.\n"
+            "# TYPE marquee_free_heap_bytes gauge\n"
+            "marquee_free_heap_bytes 123456\n"
+            "# HELP marquee_frame_seconds Time to draw a frame.\n"
+            "# TYPE marquee_frame_seconds histogram\n"
+            "marquee_frame_seconds_bucket{le=\"0.001\"} 1\n"
+            "marquee_frame_seconds_bucket{le=\"0.02\"} 2\n"
+            "marquee_frame_seconds_bucket{le=\"+Inf\"} 3\n"
+            "marquee_frame_seconds_sum 0.042\n"
+            "marquee_frame_seconds_count 3\n");
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
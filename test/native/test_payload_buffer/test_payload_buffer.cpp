@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <payload_buffer.h>
+
+#include <string>
+
+using led_marquee::PayloadBuffer;
+
+TEST(PayloadBufferTest, PassesWholePayloads) {
+  PayloadBuffer<16> buffer;
+
+  EXPECT_TRUE(buffer.Add("{\"a\": 1}", 8, 0, 8));
+  EXPECT_EQ(buffer.payload(), "{\"a\": 1}");
+  EXPECT_EQ(buffer.payload().data()[8], '\0');
+
+  EXPECT_TRUE(buffer.Add("", 0, 0, 0));
+  EXPECT_EQ(buffer.payload(), "");
+  EXPECT_EQ(buffer.received(), 2u);
+}
+
+TEST(PayloadBufferTest, ReassemblesPieces) {
+  PayloadBuffer<32> buffer;
+  const std::string payload = "{\"text\": \"in several pieces\"}";
+
+  for (std::size_t i = 0; i < payload.size(); i += 8) {
+    const std::size_t len = std::min<std::size_t>(8, payload.size() - i);
+    const bool last = i + len == payload.size();
+    EXPECT_EQ(buffer.Add(payload.data() + i, len, i, payload.size()), last);
+  }
+  EXPECT_EQ(buffer.payload(), payload);
+  EXPECT_EQ(buffer.dropped(), 0u);
+}
+
+TEST(PayloadBufferTest, CountsOversizedPayloads) {
+  PayloadBuffer<8> buffer;
+
+  EXPECT_FALSE(buffer.Add("012345678", 5, 0, 9));
+  EXPECT_FALSE(buffer.Add("5678", 4, 5, 9));
+  EXPECT_EQ(buffer.oversized(), 1u);
+  EXPECT_EQ(buffer.dropped(), 0u);
+
+  // Exactly full is fine
+  EXPECT_TRUE(buffer.Add("01234567", 8, 0, 8));
+  EXPECT_EQ(buffer.payload(), "01234567");
+}
+
+TEST(PayloadBufferTest, DropsIncompletePayloads) {
+  PayloadBuffer<16> buffer;
+
+  // The second half never arrives
+  EXPECT_FALSE(buffer.Add("abcd", 4, 0, 8));
+  EXPECT_TRUE(buffer.Add("next", 4, 0, 4));
+  EXPECT_EQ(buffer.payload(), "next");
+  EXPECT_EQ(buffer.dropped(), 1u);
+
+  // A piece goes missing in the middle
+  EXPECT_FALSE(buffer.Add("ab", 2, 0, 6));
+  EXPECT_FALSE(buffer.Add("ef", 2, 4, 6));
+  EXPECT_EQ(buffer.dropped(), 2u);
+  EXPECT_EQ(buffer.received(), 1u);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <pending_controls.h>
+#include <render_command.h>
+
+#include <thread>
+#include <vector>
+
+using led_marquee::PendingControls;
+using led_marquee::RenderCommand;
+
+namespace {
+
+std::vector<RenderCommand> TakeAll(PendingControls &controls) {
+  std::vector<RenderCommand> commands;
+  controls.TakeAll(
+      [&](const RenderCommand &command) { commands.push_back(command); });
+  return commands;
+}
+
+// A batch as the render task gets it: commands, stamped when posted
+struct Batch {
+  std::vector<RenderCommand> commands;
+  uint32_t epoch;
+};
+
+// Applies a batch the way the render task does, skipping controls that have
+// been set since it was posted
+std::vector<RenderCommand> ApplyBatch(PendingControls &controls,
+                                      const Batch &batch) {
+  std::vector<RenderCommand> applied;
+  for (const auto &command : batch.commands) {
+    if (PendingControls::IsControl(command.type) &&
+        !controls.Supersede(command.type, batch.epoch)) {
+      continue;
+    }
+    applied.push_back(command);
+  }
+  return applied;
+}
+
+}  // namespace
+
+TEST(PendingControlsTest, KeepsTheLatestValue) {
+  PendingControls controls;
+  EXPECT_TRUE(TakeAll(controls).empty());
+
+  controls.Set(RenderCommand::Type::kTextColor, 0xff0000);
+  controls.Set(RenderCommand::Type::kBrightness, 10);
+  controls.Set(RenderCommand::Type::kTextColor, 0x00ff00);
+  controls.Set(RenderCommand::Type::kTextColor, 0x0000ff);
+
+  const auto commands = TakeAll(controls);
+  ASSERT_EQ(commands.size(), 2u);
+  EXPECT_EQ(commands[0].type, RenderCommand::Type::kTextColor);
+  EXPECT_EQ(commands[0].value, 0x0000ffu);
+  EXPECT_EQ(commands[1].type, RenderCommand::Type::kBrightness);
+  EXPECT_EQ(commands[1].value, 10u);
+
+  EXPECT_EQ(controls.updates(), 4u);
+  EXPECT_EQ(controls.coalesced(), 2u);
+
+  // Taken, so there's nothing until the next change
+  EXPECT_TRUE(TakeAll(controls).empty());
+}
+
+TEST(PendingControlsTest, PassesZero) {
+  PendingControls controls;
+
+  controls.Set(RenderCommand::Type::kEnable, 0);
+  const auto commands = TakeAll(controls);
+  ASSERT_EQ(commands.size(), 1u);
+  EXPECT_EQ(commands[0].type, RenderCommand::Type::kEnable);
+  EXPECT_EQ(commands[0].value, 0u);
+}
+
+TEST(PendingControlsTest, EndsWithTheLastValue) {
+  constexpr uint32_t kUpdates = 10000;
+  PendingControls controls;
+
+  std::thread setter([&] {
+    for (uint32_t i = 1; i <= kUpdates; i++) {
+      controls.Set(RenderCommand::Type::kSpeed, i);
+    }
+  });
+
+  // Whatever gets taken along the way only goes forward
+  uint32_t last = 0;
+  uint32_t taken = 0;
+  const auto take = [&](const RenderCommand &command) {
+    EXPECT_GE(command.value, last);
+    last = command.value;
+    taken++;
+  };
+  while (last < kUpdates) controls.TakeAll(take);
+  setter.join();
+
+  EXPECT_EQ(last, kUpdates);
+  EXPECT_EQ(taken + controls.coalesced(), kUpdates);
+}
+
+TEST(PendingControlsTest, TakesControlsSetAtOnceTogether) {
+  constexpr uint32_t kUpdates = 10000;
+  PendingControls controls;
+
+  std::thread setter([&] {
+    for (uint32_t i = 1; i <= kUpdates; i++) {
+      const RenderCommand commands[] = {
+          {RenderCommand::Type::kTextColor, i},
+          {RenderCommand::Type::kSpeed, i},
+      };
+      controls.Set(commands, 2);
+    }
+  });
+
+  // After each frame's worth, the two always match
+  uint32_t color = 0;
+  uint32_t speed = 0;
+  const auto take = [&](const RenderCommand &command) {
+    if (command.type == RenderCommand::Type::kTextColor) {
+      color = command.value;
+    } else {
+      speed = command.value;
+    }
+  };
+  while (speed < kUpdates) {
+    controls.TakeAll(take);
+    ASSERT_EQ(color, speed);
+  }
+  setter.join();
+}
+
+TEST(PendingControlsTest, KeepsABatchTogether) {
+  PendingControls controls;
+
+  // A frame takes the controls, then a batch comes in before it gets to the
+  // queue. A control set before the batch doesn't count.
+  EXPECT_TRUE(TakeAll(controls).empty());
+  controls.Set(RenderCommand::Type::kTextColor, 0x0000ff);
+  const Batch batch{{{RenderCommand::Type::kTextColor, 0xff0000},
+                     {RenderCommand::Type::kSpeed, 30},
+                     {RenderCommand::Type::kStaticText}},
+                    controls.Stamp()};
+
+  // The batch's settings go with its text, on the same frame
+  const auto applied = ApplyBatch(controls, batch);
+  ASSERT_EQ(applied.size(), 3u);
+  EXPECT_EQ(applied[0].type, RenderCommand::Type::kTextColor);
+  EXPECT_EQ(applied[0].value, 0xff0000u);
+  EXPECT_EQ(applied[1].type, RenderCommand::Type::kSpeed);
+  EXPECT_EQ(applied[2].type, RenderCommand::Type::kStaticText);
+
+  // And the older color doesn't come along after it
+  EXPECT_TRUE(TakeAll(controls).empty());
+}
+
+TEST(PendingControlsTest, LetsLaterControlsWinOverABatch) {
+  PendingControls controls;
+
+  const Batch batch{{{RenderCommand::Type::kTextColor, 0xff0000},
+                     {RenderCommand::Type::kBrightness, 10}},
+                    controls.Stamp()};
+  controls.Set(RenderCommand::Type::kTextColor, 0x00ff00);
+
+  // Taken first, so the batch's own color is skipped
+  auto commands = TakeAll(controls);
+  ASSERT_EQ(commands.size(), 1u);
+  EXPECT_EQ(commands[0].value, 0x00ff00u);
+  commands = ApplyBatch(controls, batch);
+  ASSERT_EQ(commands.size(), 1u);
+  EXPECT_EQ(commands[0].type, RenderCommand::Type::kBrightness);
+
+  // Or applied on a later frame, after the batch
+  const Batch later{{{RenderCommand::Type::kTextColor, 0xff0000}},
+                    controls.Stamp()};
+  controls.Set(RenderCommand::Type::kTextColor, 0x0000ff);
+  EXPECT_EQ(ApplyBatch(controls, later).size(), 1u);
+  commands = TakeAll(controls);
+  ASSERT_EQ(commands.size(), 1u);
+  EXPECT_EQ(commands[0].value, 0x0000ffu);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
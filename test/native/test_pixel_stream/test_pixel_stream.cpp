@@ -0,0 +1,280 @@
+#include <arpa/inet.h>
+#include <framebuffer.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <pixel_stream.h>
+#include <rgb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using led_marquee::Framebuffer;
+using led_marquee::PixelStream;
+using led_marquee::Rgb;
+
+namespace {
+
+// A DDP packet with `pixels` starting at pixel `first`
+std::vector<uint8_t> Packet(const std::vector<Rgb> &pixels, size_t first = 0,
+                            uint8_t sequence = 0, bool push = true) {
+  const size_t offset = first * 3;
+  const size_t length = pixels.size() * 3;
+  std::vector<uint8_t> packet = {
+      static_cast<uint8_t>(PixelStream::kVersion1 |
+                           (push ? PixelStream::kPush : 0)),
+      sequence,
+      PixelStream::kTypeRgb8,
+      1,
+      static_cast<uint8_t>(offset >> 24),
+      static_cast<uint8_t>(offset >> 16),
+      static_cast<uint8_t>(offset >> 8),
+      static_cast<uint8_t>(offset),
+      static_cast<uint8_t>(length >> 8),
+      static_cast<uint8_t>(length)};
+  for (const Rgb &p : pixels) packet.insert(packet.end(), {p.r, p.g, p.b});
+  return packet;
+}
+
+// A frame that's all one color
+std::vector<uint8_t> Fill(int pixels, Rgb color, uint8_t sequence = 0) {
+  return Packet(std::vector<Rgb>(static_cast<size_t>(pixels), color), 0,
+                sequence);
+}
+
+bool Receive(PixelStream &stream, const std::vector<uint8_t> &packet,
+             uint32_t now_ms = 0) {
+  return stream.Receive(packet.data(), packet.size(), now_ms);
+}
+
+constexpr Rgb kRed{255, 0, 0};
+constexpr Rgb kGreen{0, 255, 0};
+constexpr Rgb kBlue{0, 0, 255};
+
+}  // namespace
+
+TEST(PixelStreamTest, AssemblesFramesFromRows) {
+  PixelStream stream(3, 2, 1);
+  Framebuffer frame(3, 2);
+  EXPECT_FALSE(stream.Active(0));
+
+  // Top row, then bottom row in a second packet that completes the frame
+  EXPECT_TRUE(Receive(stream, Packet({kRed, kGreen, kBlue}, 0, 1, false)));
+  EXPECT_FALSE(stream.NextFrame(frame));
+  EXPECT_TRUE(Receive(stream, Packet({kBlue, kBlue, kRed}, 3, 1)));
+  EXPECT_TRUE(stream.Active(0));
+
+  ASSERT_TRUE(stream.NextFrame(frame));
+  EXPECT_EQ(frame.Get(0, 1), kRed);
+  EXPECT_EQ(frame.Get(1, 1), kGreen);
+  EXPECT_EQ(frame.Get(2, 1), kBlue);
+  EXPECT_EQ(frame.Get(0, 0), kBlue);
+  EXPECT_EQ(frame.Get(2, 0), kRed);
+  EXPECT_EQ(stream.frames(), 1u);
+
+  // Only one frame was sent
+  EXPECT_FALSE(stream.NextFrame(frame));
+}
+
+TEST(PixelStreamTest, KeepsPixelsThatWereNotSent) {
+  PixelStream stream(2, 2, 1);
+  Framebuffer frame(2, 2);
+
+  Receive(stream, Fill(4, kRed));
+  // Just the last pixel, not even a whole one at that
+  auto packet = Packet({kGreen}, 3);
+  packet.pop_back();
+  packet[9] = 2;
+  Receive(stream, packet);
+
+  ASSERT_TRUE(stream.NextFrame(frame));
+  ASSERT_TRUE(stream.NextFrame(frame));
+  EXPECT_EQ(frame.Get(0, 0), kRed);
+  EXPECT_EQ(frame.Get(1, 0), (Rgb{0, 255, 0}));
+  EXPECT_EQ(frame.Get(1, 1), kRed);
+
+  // Anything past the end of the display is ignored
+  EXPECT_TRUE(Receive(stream, Packet({kBlue, kBlue, kBlue}, 2)));
+  ASSERT_TRUE(stream.NextFrame(frame));
+  EXPECT_EQ(frame.Get(0, 0), kBlue);
+  EXPECT_EQ(frame.Get(1, 0), kBlue);
+}
+
+TEST(PixelStreamTest, BuffersAgainstJitter) {
+  PixelStream stream(1, 1, 2);
+  Framebuffer frame(1, 1);
+
+  // Nothing until two frames are waiting
+  Receive(stream, Fill(1, kRed), 0);
+  EXPECT_FALSE(stream.NextFrame(frame));
+  Receive(stream, Fill(1, kGreen), 40);
+  ASSERT_TRUE(stream.NextFrame(frame));
+  EXPECT_EQ(frame.Get(0, 0), kRed);
+
+  Receive(stream, Fill(1, kBlue), 50);
+  ASSERT_TRUE(stream.NextFrame(frame));
+  EXPECT_EQ(frame.Get(0, 0), kGreen);
+  ASSERT_TRUE(stream.NextFrame(frame));
+  EXPECT_EQ(frame.Get(0, 0), kBlue);
+
+  // Run dry, then wait for it to fill up again
+  EXPECT_FALSE(stream.NextFrame(frame));
+  EXPECT_EQ(stream.underruns(), 1u);
+  Receive(stream, Fill(1, kRed), 60);
+  EXPECT_FALSE(stream.NextFrame(frame));
+  Receive(stream, Fill(1, kGreen), 70);
+  EXPECT_TRUE(stream.NextFrame(frame));
+}
+
+TEST(PixelStreamTest, DropsOldestFramesWhenFull) {
+  PixelStream stream(1, 1, 1);
+  Framebuffer frame(1, 1);
+
+  for (uint8_t i = 0; i < 10; i++) Receive(stream, Fill(1, Rgb{i, 0, 0}));
+  EXPECT_GT(stream.overruns(), 0u);
+
+  // The newest frames are kept, in order. There's room for a couple more than
+  // the jitter buffer needs.
+  ASSERT_TRUE(stream.NextFrame(frame));
+  const uint8_t first = frame.Get(0, 0).r;
+  EXPECT_EQ(first, 7);
+  for (uint8_t i = first + 1; i < 10; i++) {
+    ASSERT_TRUE(stream.NextFrame(frame));
+    EXPECT_EQ(frame.Get(0, 0).r, i);
+  }
+  EXPECT_FALSE(stream.NextFrame(frame));
+}
+
+TEST(PixelStreamTest, UsesSequenceNumbers) {
+  PixelStream stream(2, 1, 1);
+  Framebuffer frame(2, 1);
+
+  Receive(stream, Packet({kRed}, 0, 15, false));
+  Receive(stream, Packet({kRed}, 1, 15));
+
+  // A straggler from the frame that's already done
+  Receive(stream, Packet({kBlue}, 1, 15));
+  EXPECT_EQ(stream.late(), 1u);
+
+  // Frame 1 never gets its push, so frame 2 starts over from frame 15
+  Receive(stream, Packet({kGreen}, 0, 1, false));
+  Receive(stream, Packet({kBlue}, 1, 2));
+  EXPECT_EQ(stream.incomplete(), 1u);
+
+  ASSERT_TRUE(stream.NextFrame(frame));
+  ASSERT_TRUE(stream.NextFrame(frame));
+  EXPECT_EQ(frame.Get(0, 0), kRed);
+  EXPECT_EQ(frame.Get(1, 0), kBlue);
+  EXPECT_EQ(stream.frames(), 2u);
+}
+
+TEST(PixelStreamTest, TimesOut) {
+  PixelStream stream(1, 1, 1, 1000);
+  Framebuffer frame(1, 1);
+
+  for (uint32_t ms = 0; ms <= 500; ms += 20) {
+    Receive(stream, Fill(1, kRed), ms);
+  }
+  EXPECT_EQ(stream.FrameInterval(), 20);
+  EXPECT_TRUE(stream.Active(1500));
+  EXPECT_FALSE(stream.Active(1501));
+
+  // A new stream doesn't play what was left over from the old one
+  Receive(stream, Fill(1, kGreen, 3), 5000);
+  ASSERT_TRUE(stream.NextFrame(frame));
+  EXPECT_EQ(frame.Get(0, 0), kGreen);
+  EXPECT_FALSE(stream.NextFrame(frame));
+}
+
+TEST(PixelStreamTest, IgnoresOtherPackets) {
+  PixelStream stream(1, 1, 1);
+
+  auto packet = Fill(1, kRed);
+  EXPECT_FALSE(stream.Receive(packet.data(), 9, 0));
+  EXPECT_FALSE(stream.Receive(packet.data(), packet.size() - 1, 0));
+
+  auto query = packet;
+  query[0] |= PixelStream::kQuery;
+  EXPECT_FALSE(Receive(stream, query));
+
+  auto version2 = packet;
+  version2[0] = 0x80 | PixelStream::kPush;
+  EXPECT_FALSE(Receive(stream, version2));
+
+  auto rgbw = packet;
+  rgbw[2] = 0x1b;
+  EXPECT_FALSE(Receive(stream, rgbw));
+
+  EXPECT_EQ(stream.frames(), 0u);
+}
+
+// Shows whatever's sent to PIXEL_STREAM_PORT, e.g. by
+// stream_examples/plasma.py --host 127.0.0.1, as text. Only runs when the
+// port is set.
+TEST(PixelStreamTest, Listen) {
+  const char *port = getenv("PIXEL_STREAM_PORT");
+  if (!port) GTEST_SKIP() << "Set PIXEL_STREAM_PORT to listen for a stream";
+
+  const int width = 32, height = 8;
+  PixelStream stream(width, height);
+  Framebuffer frame(width, height);
+
+  const int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  ASSERT_GE(sock, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(static_cast<uint16_t>(atoi(port)));
+  ASSERT_EQ(bind(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+  timeval poll{0, 1000};
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &poll, sizeof(poll));
+
+  const auto start = std::chrono::steady_clock::now();
+  auto now_ms = [&] {
+    return static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+  };
+
+  // Until the stream has come and gone
+  uint32_t next_frame = 0;
+  while (!stream.frames() || stream.Active(now_ms())) {
+    uint8_t packet[1500];
+    const ssize_t size = recv(sock, packet, sizeof(packet), 0);
+    if (size > 0) stream.Receive(packet, static_cast<size_t>(size), now_ms());
+
+    if (now_ms() < next_frame || !stream.NextFrame(frame)) continue;
+    next_frame = now_ms() + static_cast<uint32_t>(stream.FrameInterval());
+
+    printf("\033[H");
+    for (int y = height - 1; y >= 0; y--) {
+      for (int x = 0; x < width; x++) {
+        const Rgb p = frame.Get(x, y);
+        printf("\033[48;2;%d;%d;%dm  ", p.r, p.g, p.b);
+      }
+      printf("\033[0m\n");
+    }
+  }
+  close(sock);
+
+  printf("%u frames, %u late, %u incomplete, %u overruns, %u underruns\n",
+         stream.frames(), stream.late(), stream.incomplete(),
+         stream.overruns(), stream.underruns());
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
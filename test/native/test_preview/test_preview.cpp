@@ -0,0 +1,132 @@
+#include <framebuffer.h>
+#include <gtest/gtest.h>
+#include <preview.h>
+#include <rgb.h>
+
+#include <cstdint>
+#include <vector>
+
+using led_marquee::Framebuffer;
+using led_marquee::Preview;
+using led_marquee::Rgb;
+
+namespace {
+
+constexpr Rgb kRed{255, 0, 0};
+constexpr Rgb kBlue{0, 0, 255};
+
+// Applies an encoded frame to `pixels`, as a viewer would
+void Decode(const std::vector<uint8_t> &encoded, std::vector<Rgb> &pixels) {
+  ASSERT_GE(encoded.size(), Preview::kHeaderSize);
+  const size_t width = encoded[1] | encoded[2] << 8;
+  const size_t height = encoded[3] | encoded[4] << 8;
+  if (encoded[0] == Preview::kKeyFrame) {
+    pixels.assign(width * height, Rgb{});
+  }
+  ASSERT_EQ(pixels.size(), width * height);
+
+  size_t p = 0;
+  for (size_t i = Preview::kHeaderSize; i < encoded.size();) {
+    const uint8_t token = encoded[i++];
+    if (token < 0x80) {
+      p += token + 1u;
+    } else {
+      const Rgb color{encoded[i], encoded[i + 1], encoded[i + 2]};
+      i += 3;
+      for (int n = token - 0x7f; n > 0; n--) pixels[p++] = color;
+    }
+  }
+  EXPECT_EQ(p, pixels.size());
+}
+
+std::vector<Rgb> Pixels(const Framebuffer &frame) {
+  return std::vector<Rgb>(frame.data(), frame.data() + frame.size());
+}
+
+}  // namespace
+
+TEST(PreviewTest, SendsOnlyChanges) {
+  Framebuffer frame(32, 8);
+  Preview preview(32, 8, 0);
+  std::vector<uint8_t> encoded;
+  std::vector<Rgb> viewer;
+
+  frame.FillArea(0, 0, 3, 8, kRed);
+  preview.Capture(frame, 0);
+  ASSERT_TRUE(preview.Encode(encoded, true));
+  Decode(encoded, viewer);
+  EXPECT_EQ(viewer, Pixels(frame));
+  // One run of red, and the rest unchanged from black
+  EXPECT_EQ(encoded.size(), Preview::kHeaderSize + 4 + 2);
+
+  // Nothing new
+  EXPECT_FALSE(preview.Encode(encoded));
+  preview.Capture(frame, 1);
+  EXPECT_FALSE(preview.Encode(encoded));
+
+  frame.Set(10, 4, kBlue);
+  frame.Set(31, 7, kBlue);
+  preview.Capture(frame, 2);
+  ASSERT_TRUE(preview.Encode(encoded));
+  EXPECT_EQ(encoded[0], Preview::kDeltaFrame);
+  Decode(encoded, viewer);
+  EXPECT_EQ(viewer, Pixels(frame));
+  EXPECT_LT(encoded.size(), 20u);
+}
+
+TEST(PreviewTest, HandlesLongRuns) {
+  Framebuffer frame(64, 8);
+  Preview preview(64, 8, 0);
+  std::vector<uint8_t> encoded;
+  std::vector<Rgb> viewer;
+
+  // Longer than one token can cover, of both kinds
+  frame.FillArea(0, 0, 40, 8, kRed);
+  for (int x = 0; x < 64; x += 2) {
+    frame.Set(x, 0, Rgb{1, 2, static_cast<uint8_t>(x)});
+  }
+  preview.Capture(frame, 0);
+  ASSERT_TRUE(preview.Encode(encoded, true));
+  Decode(encoded, viewer);
+  EXPECT_EQ(viewer, Pixels(frame));
+
+  frame.Clear();
+  preview.Capture(frame, 1);
+  ASSERT_TRUE(preview.Encode(encoded));
+  Decode(encoded, viewer);
+  EXPECT_EQ(viewer, Pixels(frame));
+}
+
+TEST(PreviewTest, LimitsTheFrameRate) {
+  Framebuffer frame(4, 4);
+  Preview preview(4, 4, 100);
+  std::vector<uint8_t> encoded;
+
+  preview.Capture(frame, 100);
+  frame.Set(0, 0, kRed);
+  preview.Capture(frame, 150);
+
+  // The second frame was too soon, so it's still black, like the viewer
+  EXPECT_FALSE(preview.Encode(encoded));
+  std::vector<Rgb> viewer;
+  ASSERT_TRUE(preview.Encode(encoded, true));
+  Decode(encoded, viewer);
+  EXPECT_EQ(viewer[0], Rgb{});
+
+  preview.Capture(frame, 200);
+  ASSERT_TRUE(preview.Encode(encoded));
+  Decode(encoded, viewer);
+  EXPECT_EQ(viewer[0], kRed);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
@@ -0,0 +1,402 @@
+#include <clock.h>
+#include <display_manager.h>
+#include <framebuffer.h>
+#include <gtest/gtest.h>
+#include <host_output.h>
+#include <rgb.h>
+#include <text_renderer.h>
+#include <text_scroller.h>
+
+#include <memory>
+#include <string>
+
+using namespace std::string_literals;
+using led_marquee::Rgb;
+
+// 3x5 font with just 'H' and 'I'
+const uint8_t kTestFont[] = {
+    3,    5,    'H',  'I',                // header
+    0xa0, 0xa0, 0xe0, 0xa0, 0xa0,         // H
+    0xe0, 0x40, 0x40, 0x40, 0xe0,         // I
+};
+
+constexpr Rgb kWhite{0xff, 0xff, 0xff};
+constexpr Rgb kRed{0xff, 0x00, 0x00};
+
+// Renders a column of the frame as a string, top row first
+std::string ColumnString(const led_marquee::Framebuffer &frame, int x) {
+  std::string s;
+  for (int y = frame.Height() - 1; y >= 0; y--) {
+    s.push_back(frame.Get(x, y) == led_marquee::kBlack ? '.' : '#');
+  }
+  return s;
+}
+
+TEST(FramebufferTest, FillAreaIsClipped) {
+  led_marquee::Framebuffer frame(4, 3);
+  frame.FillArea(-1, 1, 3, 5, kRed);
+
+  EXPECT_EQ(frame.Get(0, 0), led_marquee::kBlack);
+  EXPECT_EQ(frame.Get(0, 1), kRed);
+  EXPECT_EQ(frame.Get(1, 2), kRed);
+  EXPECT_EQ(frame.Get(2, 2), led_marquee::kBlack);
+  EXPECT_EQ(frame.Get(-1, 1), led_marquee::kBlack);
+}
+
+TEST(RgbTest, ConvertsHsv) {
+  EXPECT_EQ(led_marquee::HsvToRgb(0, 0xff, 0xff), kRed);
+  EXPECT_EQ(led_marquee::HsvToRgb(123, 0, 0x40), (Rgb{0x40, 0x40, 0x40}));
+}
+
+TEST(TextRendererTest, DrawsGlyphsFromTheTop) {
+  led_marquee::Framebuffer frame(8, 6);
+  led_marquee::TextRenderer renderer;
+  renderer.SetFont(kTestFont);
+  renderer.Init(frame, 8, 6, 0, 0);
+
+  renderer.SetText("HI");
+  EXPECT_EQ(renderer.UpdateText(), 0);
+
+  EXPECT_EQ(ColumnString(frame, 0), "#####.");
+  EXPECT_EQ(ColumnString(frame, 1), "..#...");
+  EXPECT_EQ(ColumnString(frame, 3), "......");
+  EXPECT_EQ(ColumnString(frame, 5), "#####.");
+  EXPECT_EQ(ColumnString(frame, 4), "#...#.");
+  EXPECT_EQ(frame.Get(0, 5), kWhite);
+}
+
+TEST(TextRendererTest, AppliesColorEscapes) {
+  led_marquee::Framebuffer frame(8, 5);
+  led_marquee::TextRenderer renderer;
+  renderer.SetFont(kTestFont);
+  renderer.Init(frame, 8, 5, 0, 0);
+
+  renderer.SetText("H\xe0\xff\x00\x00I"s);
+  renderer.UpdateText();
+
+  EXPECT_EQ(frame.Get(0, 4), kWhite);
+  EXPECT_EQ(frame.Get(4, 4), kRed);
+}
+
+TEST(TextRendererTest, ScrollsUntilTextIsGone) {
+  led_marquee::Framebuffer frame(4, 5);
+  led_marquee::TextRenderer renderer;
+  renderer.SetFont(kTestFont);
+  renderer.Init(frame, 4, 5, 0, 0);
+
+  renderer.SetText("HI");
+  int updates = 1;
+  while (renderer.UpdateText() != -1) updates++;
+
+  // Two characters of four columns each, plus the final empty frame
+  EXPECT_EQ(updates, 9);
+  for (int x = 0; x < 4; x++) EXPECT_EQ(ColumnString(frame, x), ".....");
+}
+
+TEST(TextRendererTest, BlendsBetweenColumns) {
+  led_marquee::Framebuffer frame(4, 5);
+  led_marquee::TextRenderer renderer;
+  renderer.SetFont(kTestFont);
+  renderer.Init(frame, 4, 5, 0, 0);
+
+  renderer.SetText("\xe0\xff\x00\x00I"s);
+  renderer.UpdateText();
+  EXPECT_EQ(ColumnString(frame, 0), "#...#");
+
+  // Halfway to the next column. Where both are lit, it's all lit.
+  renderer.RedrawBetween(128);
+  EXPECT_EQ(ColumnString(frame, 0), "#####");
+  EXPECT_EQ(frame.Get(0, 4), kRed);
+  EXPECT_EQ(frame.Get(0, 3), (Rgb{0x7f, 0x00, 0x00}));
+  // The last column is fading into the gap after it
+  EXPECT_EQ(ColumnString(frame, 2), "#...#");
+  EXPECT_EQ(frame.Get(2, 4), (Rgb{0x7f, 0x00, 0x00}));
+  EXPECT_EQ(ColumnString(frame, 3), ".....");
+}
+
+TEST(TextRendererTest, KeepsEscapedColorsWhileScrolling) {
+  led_marquee::Framebuffer frame(4, 5);
+  led_marquee::TextRenderer renderer;
+  renderer.SetFont(kTestFont);
+  renderer.Init(frame, 4, 5, 0, 0);
+
+  renderer.SetText("H\xe0\xff\x00\x00IH"s);
+  EXPECT_EQ(renderer.TextWidth(), 12);
+  for (int i = 0; i < 6; i++) renderer.UpdateText();
+
+  // The middle of the I is at column 0, and the H after it keeps its color
+  EXPECT_EQ(ColumnString(frame, 0), "#####");
+  EXPECT_EQ(frame.Get(0, 4), kRed);
+  EXPECT_EQ(ColumnString(frame, 3), "#####");
+  EXPECT_EQ(frame.Get(3, 4), kRed);
+
+  // Changing the text color doesn't affect escaped text
+  renderer.SetColor(kWhite);
+  renderer.SetText("H\xe0\xff\x00\x00IH"s);
+  renderer.UpdateText();
+  EXPECT_EQ(frame.Get(0, 4), kWhite);
+}
+
+TEST(TextRendererTest, DrawsMarkup) {
+  led_marquee::Framebuffer frame(8, 6);
+  led_marquee::TextRenderer renderer;
+  renderer.SetFont(kTestFont);
+  renderer.Init(frame, 8, 6, 0, 0);
+
+  // An HSV red 'I', then the degree icon in the text color
+  renderer.SetText("\xe5\x00\xff\xffI\xe0\xff\xff\xff\xe4\x05"s);
+  renderer.UpdateText();
+  EXPECT_EQ(ColumnString(frame, 0), "#...#.");
+  EXPECT_EQ(frame.Get(0, 5), kRed);
+  EXPECT_EQ(ColumnString(frame, 4), ".#....");
+  EXPECT_EQ(ColumnString(frame, 5), "#.#...");
+  EXPECT_EQ(frame.Get(5, 5), kWhite);
+}
+
+TEST(TextRendererTest, BlinksOnlyMarkedText) {
+  led_marquee::Framebuffer frame(8, 6);
+  led_marquee::TextRenderer renderer;
+  renderer.SetFont(kTestFont);
+  renderer.Init(frame, 8, 6, 0, 0);
+
+  renderer.SetText("H\xe3\x01I\xe3\x00"s);
+  renderer.UpdateText();
+  EXPECT_TRUE(renderer.HasBlink());
+
+  renderer.SetBlinkVisible(false);
+  renderer.Redraw();
+  EXPECT_EQ(ColumnString(frame, 0), "#####.");
+  EXPECT_EQ(ColumnString(frame, 4), "......");
+
+  renderer.SetBlinkVisible(true);
+  renderer.Redraw();
+  EXPECT_EQ(ColumnString(frame, 4), "#...#.");
+}
+
+TEST(TextScrollerTest, FollowsTimingCues) {
+  auto output = std::make_unique<led_marquee::HostOutput>(8, 6);
+  led_marquee::DisplayManager display_manager(std::move(output), 8, 6);
+  led_marquee::TextScroller text(display_manager, kTestFont);
+  text.Init(8, 6, 0, 0);
+  auto &frame = display_manager.frame();
+  text.SetSpeed(40);
+
+  // After 3 spaces, 'H' is columns 12-15, then 100 ms per column from 16,
+  // then a 200 ms pause at 20
+  text.ShowScrollText("H\xe1\x00\x64I\xe2\x00\xc8I"s);
+
+  // The speed changes once column 16 reaches the right edge
+  for (int i = 0; i < 8; i++) text.Animate();
+  EXPECT_EQ(text.FrameTime(), 40);
+  text.Animate();
+  EXPECT_EQ(text.FrameTime(), 100);
+
+  // The pause holds the frame for 2 frames at the new speed
+  for (int i = 0; i < 4; i++) text.Animate();
+  const std::string paused = ColumnString(frame, 0);
+  text.Animate();
+  text.Animate();
+  EXPECT_EQ(ColumnString(frame, 0), paused);
+  text.Animate();
+  EXPECT_NE(ColumnString(frame, 0), paused);
+
+  // Starting over goes back to the usual speed
+  text.ShowScrollText();
+  EXPECT_EQ(text.FrameTime(), 40);
+}
+
+TEST(TextScrollerTest, DrawsStaticTextImmediately) {
+  auto output = std::make_unique<led_marquee::HostOutput>(8, 6);
+  auto &host = *output;
+  led_marquee::DisplayManager display_manager(std::move(output), 8, 6);
+  led_marquee::TextScroller text(display_manager, kTestFont);
+  text.Init(8, 6, 0, 0);
+
+  text.ShowStaticText("HI");
+  EXPECT_EQ(ColumnString(display_manager.frame(), 0), "#####.");
+
+  // Shown along with the rest of the frame
+  EXPECT_EQ(host.show_count(), 0);
+  display_manager.Show();
+  EXPECT_EQ(host.show_count(), 1);
+  EXPECT_EQ(ColumnString(host.shown(), 0), "#####.");
+  EXPECT_EQ(ColumnString(host.shown(), 4), "#...#.");
+}
+
+TEST(TextScrollerTest, ScrollsInFromTheRight) {
+  auto output = std::make_unique<led_marquee::HostOutput>(8, 6);
+  led_marquee::DisplayManager display_manager(std::move(output), 8, 6);
+  led_marquee::TextScroller text(display_manager, kTestFont);
+  text.Init(8, 6, 0, 0);
+  auto &frame = display_manager.frame();
+
+  text.ShowScrollText("H");
+  text.Animate();
+  for (int x = 0; x < 8; x++) EXPECT_EQ(ColumnString(frame, x), "......");
+
+  // Leading spaces are 3 characters of 4 columns; the H starts at column 12
+  for (int i = 0; i < 12 - 7; i++) text.Animate();
+  EXPECT_EQ(ColumnString(frame, 7), "#####.");
+
+  // Keeps going until the last of the 16 columns has gone by
+  int updates = 0;
+  while (text.Animate()) updates++;
+  EXPECT_EQ(updates, 16 - 6);
+}
+
+TEST(TextScrollerTest, KnowsHowLongIsLeft) {
+  auto output = std::make_unique<led_marquee::HostOutput>(8, 6);
+  led_marquee::DisplayManager display_manager(std::move(output), 8, 6);
+  led_marquee::TextScroller text(display_manager, kTestFont);
+  text.Init(8, 6, 0, 0);
+  text.SetSpeed(40);
+
+  // 16 columns, as above, each of which is a frame, and then the frame that
+  // finds it's over
+  text.ShowScrollText("H");
+  EXPECT_EQ(text.RemainingMs(), 17 * 40);
+  for (int i = 0; i < 6; i++) text.Animate();
+  EXPECT_EQ(text.RemainingMs(), 11 * 40);
+
+  int frames = 0;
+  while (text.Animate()) frames++;
+  EXPECT_EQ(frames, 10);
+  EXPECT_EQ(text.RemainingMs(), 0);
+
+  text.ShowStaticText("HI");
+  EXPECT_EQ(text.RemainingMs(), 0);
+}
+
+TEST(TextScrollerTest, EstimatesScrollTime) {
+  auto output = std::make_unique<led_marquee::HostOutput>(8, 6);
+  led_marquee::DisplayManager display_manager(std::move(output), 8, 6);
+  led_marquee::TextScroller text(display_manager, kTestFont);
+  text.Init(8, 6, 0, 0);
+  text.SetSpeed(40);
+
+  const auto plain = text.Estimate("H");
+  EXPECT_EQ(plain.frames, 17);
+  EXPECT_EQ(plain.fixed_ms, 0);
+
+  // The markup from FollowsTimingCues: 8 frames at the usual speed, then
+  // 17 frames at 100 ms and a 200 ms pause
+  const std::string cued = "H\xe1\x00\x64I\xe2\x00\xc8I"s;
+  const auto estimate = text.Estimate(cued);
+  EXPECT_EQ(estimate.frames, 8);
+  EXPECT_EQ(estimate.fixed_ms, 17 * 100 + 200);
+
+  // Which is how long it actually takes
+  text.ShowScrollText(cued);
+  int elapsed = 0;
+  for (bool more = true; more; elapsed += text.FrameTime()) {
+    more = text.Animate();
+  }
+  EXPECT_EQ(elapsed, estimate.Ms(40));
+}
+
+TEST(DisplayManagerTest, ShowsFromTheFrontBuffer) {
+  auto output = std::make_unique<led_marquee::HostOutput>(4, 2);
+  auto &host = *output;
+  led_marquee::DisplayManager display_manager(std::move(output), 4, 2);
+
+  display_manager.FillArea(0, 0, 1, 1, kRed);
+  EXPECT_EQ(display_manager.front().Get(0, 0), led_marquee::kBlack);
+
+  display_manager.Show();
+  EXPECT_EQ(display_manager.front().Get(0, 0), kRed);
+  EXPECT_EQ(host.shown().Get(0, 0), kRed);
+
+  // Drawing carries on from the frame that was shown
+  display_manager.FillArea(1, 0, 1, 1, kRed);
+  EXPECT_EQ(display_manager.frame().Get(0, 0), kRed);
+  EXPECT_EQ(display_manager.front().Get(1, 0), led_marquee::kBlack);
+}
+
+TEST(DisplayManagerTest, OnlySendsChangedSections) {
+  auto output = std::make_unique<led_marquee::HostOutput>(6, 2, 3);
+  auto &host = *output;
+  led_marquee::DisplayManager display_manager(std::move(output), 6, 2);
+
+  // Nothing has been drawn, so there's nothing to send
+  EXPECT_FALSE(display_manager.Show());
+  EXPECT_EQ(host.show_count(), 0);
+  EXPECT_EQ(display_manager.skipped_shows(), 1u);
+
+  display_manager.FillArea(5, 1, 1, 1, kRed);
+  EXPECT_TRUE(display_manager.Show());
+  EXPECT_EQ(host.show_count(), 1);
+  EXPECT_EQ(host.dirty_sections(), 0b100u);
+
+  display_manager.FillArea(0, 0, 3, 1, kRed);
+  display_manager.Show();
+  EXPECT_EQ(host.dirty_sections(), 0b011u);
+
+  // Drawing the same pixels again isn't a change
+  display_manager.FillArea(0, 0, 3, 1, kRed);
+  EXPECT_FALSE(display_manager.Show());
+  EXPECT_EQ(host.show_count(), 2);
+
+  // Brightness only takes effect when the LEDs are sent again
+  display_manager.SetBrightness(50);
+  display_manager.Show();
+  EXPECT_EQ(host.show_count(), 3);
+  EXPECT_EQ(host.dirty_sections(), 0b111u);
+}
+
+TEST(ClockTest, DrawsInItsOwnArea) {
+  auto output = std::make_unique<led_marquee::HostOutput>(12, 6);
+  led_marquee::DisplayManager display_manager(std::move(output), 12, 6);
+  led_marquee::Clock clock(display_manager, kTestFont);
+  clock.Init(4, 6, 8, 0);
+  auto &frame = display_manager.frame();
+
+  clock.SetColorHsv(0, 0xff, 0xff);
+  clock.SetText("I");
+
+  EXPECT_EQ(ColumnString(frame, 6), "......");
+  EXPECT_EQ(ColumnString(frame, 8), "#...#.");
+  EXPECT_EQ(ColumnString(frame, 9), "#####.");
+  EXPECT_EQ(frame.Get(9, 5), kRed);
+}
+
+TEST(ClockTest, RedrawsOnlyWhatChanged) {
+  auto output = std::make_unique<led_marquee::HostOutput>(12, 6);
+  led_marquee::DisplayManager display_manager(std::move(output), 12, 6);
+  led_marquee::Clock clock(display_manager, kTestFont);
+  clock.Init(11, 6, 1, 0);
+  auto &frame = display_manager.frame();
+
+  // The clock takes up columns 1-11, with a cell every 4
+  EXPECT_TRUE(clock.SetText("HI"));
+  EXPECT_EQ(ColumnString(frame, 5), "#...#.");
+
+  // Something to show which cells were drawn again
+  frame.At(1, 0) = kRed;
+  frame.At(5, 0) = kRed;
+  EXPECT_TRUE(clock.SetText("HH"));
+  EXPECT_EQ(frame.Get(1, 0), kRed);
+  EXPECT_EQ(ColumnString(frame, 5), "#####.");
+  EXPECT_FALSE(clock.SetText("HH"));
+
+  // Shorter text erases the rest
+  EXPECT_TRUE(clock.SetText("H"));
+  EXPECT_EQ(ColumnString(frame, 5), "......");
+
+  // A new color changes everything
+  clock.SetColorHsv(0, 0xff, 0xff);
+  EXPECT_TRUE(clock.SetText("H"));
+  EXPECT_EQ(frame.Get(1, 0), led_marquee::kBlack);
+  EXPECT_EQ(frame.Get(1, 5), kRed);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <led_sections.h>
+
+#include <vector>
+
+namespace {
+
+struct Section {
+  int pin;
+  int first_pixel;
+  int num_pixels;
+};
+
+// Stands in for FastLED, recording each section it's asked to drive
+struct TestController {
+  std::vector<Section> sections;
+
+  template <uint8_t pin>
+  void AddSection(int first_pixel, int num_pixels) {
+    sections.push_back({pin, first_pixel, num_pixels});
+  }
+};
+
+}  // namespace
+
+TEST(SectionsTest, SingleSection) {
+  using Pins = led_marquee::PinList<16>;
+  static_assert(Pins::kCount == 1);
+
+  TestController controller;
+  led_marquee::AddSections(controller, Pins{}, 32 * 8);
+
+  ASSERT_EQ(controller.sections.size(), 1u);
+  EXPECT_EQ(controller.sections[0].pin, 16);
+  EXPECT_EQ(controller.sections[0].first_pixel, 0);
+  EXPECT_EQ(controller.sections[0].num_pixels, 32 * 8);
+}
+
+TEST(SectionsTest, EightSectionsCoverTheMatrix) {
+  using Pins = led_marquee::PinList<16, 17, 18, 19, 21, 22, 23, 25>;
+  static_assert(Pins::kCount == 8);
+  constexpr int kSectionPixels = 64 * 8;
+
+  TestController controller;
+  led_marquee::AddSections(controller, Pins{}, kSectionPixels);
+
+  const std::vector<int> pins = {16, 17, 18, 19, 21, 22, 23, 25};
+  ASSERT_EQ(controller.sections.size(), pins.size());
+
+  // Sections are registered in pin order, back to back with no gaps
+  int next_pixel = 0;
+  for (size_t i = 0; i < pins.size(); i++) {
+    EXPECT_EQ(controller.sections[i].pin, pins[i]);
+    EXPECT_EQ(controller.sections[i].first_pixel, next_pixel);
+    EXPECT_EQ(controller.sections[i].num_pixels, kSectionPixels);
+    next_pixel += controller.sections[i].num_pixels;
+  }
+  EXPECT_EQ(next_pixel, Pins::kCount * kSectionPixels);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
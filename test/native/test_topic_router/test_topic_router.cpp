@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include <topic_router.h>
+
+#include <string>
+
+using led_marquee::TopicRouter;
+
+TEST(TopicRouterTest, FindsHandlers) {
+  TopicRouter<int, 4> router;
+  EXPECT_TRUE(router.Add("marquee/sign", "/text", 1));
+  EXPECT_TRUE(router.Add("marquee/sign", "/display", 2));
+  EXPECT_TRUE(router.Add("marquee/sign/set", 3));
+
+  ASSERT_NE(router.Find("marquee/sign/text"), nullptr);
+  EXPECT_EQ(*router.Find("marquee/sign/text"), 1);
+  EXPECT_EQ(*router.Find("marquee/sign/display"), 2);
+  EXPECT_EQ(*router.Find("marquee/sign/set"), 3);
+
+  EXPECT_EQ(router.Find("marquee/sign/tex"), nullptr);
+  EXPECT_EQ(router.Find("marquee/sign/text/more"), nullptr);
+  EXPECT_EQ(router.Find("marquee/other/text"), nullptr);
+  EXPECT_EQ(router.Find(""), nullptr);
+}
+
+TEST(TopicRouterTest, IsReusable) {
+  TopicRouter<int, 2> router;
+  EXPECT_TRUE(router.Add("a", 1));
+  EXPECT_TRUE(router.Add("b", 2));
+  EXPECT_FALSE(router.Add("c", 3));
+  EXPECT_EQ(router.Find("c"), nullptr);
+
+  // As when reconnecting under a new node name
+  router.Clear();
+  EXPECT_EQ(router.Find("a"), nullptr);
+  EXPECT_TRUE(router.Add("c", 3));
+  EXPECT_EQ(*router.Find("c"), 3);
+  EXPECT_EQ(router.size(), 1u);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
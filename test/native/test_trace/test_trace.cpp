@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <trace.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using led_marquee::TraceEvent;
+using led_marquee::TraceRecord;
+using led_marquee::TraceRing;
+using led_marquee::TraceThread;
+
+TEST(TraceRingTest, KeepsTheNewestRecords) {
+  TraceRing<8> ring;
+  std::vector<TraceRecord> records;
+
+  ring.Snapshot(records);
+  EXPECT_TRUE(records.empty());
+
+  ring.Record(100, TraceEvent::kFrameBegin, TraceThread::kRender);
+  ring.Record(150, TraceEvent::kCommand, TraceThread::kCore0, 3);
+  ring.Snapshot(records);
+  ASSERT_EQ(records.size(), 2u);
+  EXPECT_EQ(records[0].time_us, 100u);
+  EXPECT_EQ(records[0].event, TraceEvent::kFrameBegin);
+  EXPECT_EQ(records[1].thread, TraceThread::kCore0);
+  EXPECT_EQ(records[1].arg, 3u);
+
+  for (uint32_t i = 2; i < 20; i++) {
+    ring.Record(i, TraceEvent::kMessage, TraceThread::kLoop, i);
+  }
+  ring.Snapshot(records);
+  ASSERT_EQ(records.size(), 8u);
+  for (uint32_t i = 0; i < 8; i++) EXPECT_EQ(records[i].arg, 12 + i);
+  EXPECT_EQ(ring.recorded(), 20u);
+}
+
+// Records are never torn, even with writers lapping the reader
+TEST(TraceRingTest, RecordsFromAnyThread) {
+  constexpr uint32_t kWriters = 4, kRecords = 100000;
+  TraceRing<64> ring;
+  std::atomic<bool> done{false};
+
+  std::vector<std::thread> writers;
+  for (uint32_t w = 0; w < kWriters; w++) {
+    writers.emplace_back([&ring, w]() {
+      for (uint32_t i = 0; i < kRecords; i++) {
+        const uint32_t arg = w << 24 | i;
+        ring.Record(~arg, static_cast<TraceEvent>(w),
+                    static_cast<TraceThread>(w), arg);
+      }
+    });
+  }
+
+  std::thread reader([&]() {
+    std::vector<TraceRecord> records;
+    while (!done) {
+      ring.Snapshot(records);
+      for (const auto &record : records) {
+        ASSERT_EQ(record.time_us, ~record.arg);
+        ASSERT_EQ(static_cast<uint32_t>(record.event), record.arg >> 24);
+        ASSERT_EQ(static_cast<uint32_t>(record.thread), record.arg >> 24);
+      }
+    }
+  });
+
+  for (auto &writer : writers) writer.join();
+  done = true;
+  reader.join();
+
+  EXPECT_EQ(ring.recorded(), kWriters * kRecords);
+  std::vector<TraceRecord> records;
+  ring.Snapshot(records);
+  EXPECT_EQ(records.size(), 64u);
+}
+
+TEST(TraceRingTest, WritesTheDumpFormat) {
+  const std::vector<TraceRecord> records = {
+      {0x01020304, TraceEvent::kShowEnd, TraceThread::kRender, 7}};
+  std::vector<uint8_t> out;
+  led_marquee::WriteTrace(records, 0x11223344, out);
+
+  const std::vector<uint8_t> header = {
+      'L', 'M', 'T', 'R', 1, static_cast<uint8_t>(TraceEvent::kCount),
+      static_cast<uint8_t>(TraceThread::kCount), 0, 0x44, 0x33, 0x22, 0x11,
+      'B', 'f', 'r', 'a', 'm', 'e', 0, 0};
+  ASSERT_GT(out.size(), header.size() + 16);
+  EXPECT_EQ(std::vector<uint8_t>(out.begin(), out.begin() + header.size()),
+            header);
+
+  const std::vector<uint8_t> tail = {1, 0, 0, 0, 4, 3, 2, 1, 3, 0, 0, 0,
+                                     7, 0, 0, 0};
+  EXPECT_EQ(std::vector<uint8_t>(out.end() - 16, out.end()), tail);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
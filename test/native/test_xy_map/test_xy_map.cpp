@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <xy_map.h>
+
+#include <cstddef>
+#include <set>
+
+using led_marquee::MatrixType;
+using led_marquee::XyIndex;
+using led_marquee::XyTable;
+
+TEST(XyMapTest, MatchesLedMatrix) {
+  // Vertical zigzag, 4 columns of 3, data in at the bottom left:
+  //   2 3 8 9
+  //   1 4 7 10
+  //   0 5 6 11
+  EXPECT_EQ(XyIndex(MatrixType::kVerticalZigzag, 4, 3, false, 0, 0), 0);
+  EXPECT_EQ(XyIndex(MatrixType::kVerticalZigzag, 4, 3, false, 0, 2), 2);
+  EXPECT_EQ(XyIndex(MatrixType::kVerticalZigzag, 4, 3, false, 1, 2), 3);
+  EXPECT_EQ(XyIndex(MatrixType::kVerticalZigzag, 4, 3, false, 1, 0), 5);
+  EXPECT_EQ(XyIndex(MatrixType::kVerticalZigzag, 4, 3, false, 3, 0), 11);
+
+  // The same, with data in at the bottom right
+  EXPECT_EQ(XyIndex(MatrixType::kVerticalZigzag, 4, 3, true, 3, 0), 0);
+  EXPECT_EQ(XyIndex(MatrixType::kVerticalZigzag, 4, 3, true, 2, 0), 5);
+  EXPECT_EQ(XyIndex(MatrixType::kVerticalZigzag, 4, 3, true, 0, 0), 11);
+
+  // Horizontal zigzag, 3 columns of 2:
+  //   5 4 3
+  //   0 1 2
+  EXPECT_EQ(XyIndex(MatrixType::kHorizontalZigzag, 3, 2, false, 2, 0), 2);
+  EXPECT_EQ(XyIndex(MatrixType::kHorizontalZigzag, 3, 2, false, 2, 1), 3);
+  EXPECT_EQ(XyIndex(MatrixType::kHorizontalZigzag, 3, 2, false, 0, 1), 5);
+}
+
+template <MatrixType Type, int Width, int Height, bool Reverse>
+void ExpectTableMatches() {
+  const auto &table = XyTable<Type, Width, Height, Reverse>::kIndex;
+  std::set<int> seen;
+  for (int x = 0; x < Width; x++) {
+    for (int y = 0; y < Height; y++) {
+      const int index = table[static_cast<std::size_t>(x * Height + y)];
+      EXPECT_EQ(index, XyIndex(Type, Width, Height, Reverse, x, y));
+      seen.insert(index);
+    }
+  }
+  // Every LED is used exactly once
+  EXPECT_EQ(seen.size(), table.size());
+  EXPECT_EQ(*seen.rbegin(), Width * Height - 1);
+}
+
+TEST(XyMapTest, TableMatchesArithmetic) {
+  ExpectTableMatches<MatrixType::kVerticalZigzag, 288, 8, true>();
+  ExpectTableMatches<MatrixType::kVerticalZigzag, 32, 8, false>();
+  ExpectTableMatches<MatrixType::kVertical, 7, 5, true>();
+  ExpectTableMatches<MatrixType::kHorizontal, 7, 5, false>();
+  ExpectTableMatches<MatrixType::kHorizontalZigzag, 7, 5, true>();
+}
+
+// The table is really built at compile time
+static_assert(
+    XyTable<MatrixType::kVerticalZigzag, 4, 3, true>::kIndex[0] == 11);
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
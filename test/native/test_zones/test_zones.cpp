@@ -0,0 +1,276 @@
+#include <display_manager.h>
+#include <fields.h>
+#include <framebuffer.h>
+#include <gtest/gtest.h>
+#include <host_output.h>
+#include <rgb.h>
+#include <stdint.h>
+#include <time.h>
+#include <zone_layout.h>
+#include <zones.h>
+
+#include <memory>
+#include <string>
+
+namespace {
+
+using led_marquee::Rgb;
+using led_marquee::ZoneSpec;
+using led_marquee::ZoneType;
+
+time_t fake_time = 0;
+uint32_t fake_millis = 0;
+
+time_t FakeTime() { return fake_time; }
+uint32_t FakeMillis() { return fake_millis; }
+
+// 3x5 font with just 'H' and 'I'
+const uint8_t kTestFont[] = {
+    3,    5,    'H',  'I',                // header
+    0xa0, 0xa0, 0xe0, 0xa0, 0xa0,         // H
+    0xe0, 0x40, 0x40, 0x40, 0xe0,         // I
+};
+
+constexpr Rgb kRed{0xff, 0x00, 0x00};
+
+// Renders a column of the frame as a string, top row first
+std::string ColumnString(const led_marquee::Framebuffer &frame, int x) {
+  std::string s;
+  for (int y = frame.Height() - 1; y >= 0; y--) {
+    s.push_back(frame.Get(x, y) == led_marquee::kBlack ? '.' : '#');
+  }
+  return s;
+}
+
+class ZoneLayoutTest : public ::testing::Test {
+ protected:
+  ZoneLayoutTest()
+      : display_manager_(std::make_unique<led_marquee::HostOutput>(16, 6),
+                         16, 6),
+        fields_(FakeTime, FakeMillis) {
+    fake_time = 0;
+    fake_millis = 0;
+  }
+
+  led_marquee::DisplayManager display_manager_;
+  led_marquee::Fields fields_;
+};
+
+}  // namespace
+
+TEST_F(ZoneLayoutTest, KeepsZonesInTheirOwnAreas) {
+  const ZoneSpec specs[] = {
+      {ZoneType::kScroller, 0, 0, 8, 6},
+      {ZoneType::kText, 8, 0, 4, 6, nullptr, 0, "I"},
+      {ZoneType::kBar, 12, 0, 4, 6, nullptr, 0, "", kRed},
+  };
+  led_marquee::ZoneLayout layout(display_manager_, specs, 3, kTestFont,
+                                 &fields_, FakeTime);
+  auto &frame = display_manager_.frame();
+
+  layout.zone(2)->SetValue(50);
+  EXPECT_TRUE(layout.Update(0));
+
+  EXPECT_EQ(ColumnString(frame, 8), "#...#.");
+  EXPECT_EQ(ColumnString(frame, 9), "#####.");
+  EXPECT_EQ(frame.Get(13, 0), kRed);
+  EXPECT_EQ(frame.Get(14, 0), led_marquee::kBlack);
+  EXPECT_EQ(layout.zone(3), nullptr);
+}
+
+TEST_F(ZoneLayoutTest, DrawsOnlyWhenDueOrChanged) {
+  const ZoneSpec specs[] = {
+      {ZoneType::kText, 0, 0, 8, 6, nullptr, 100, "H"},
+      {ZoneType::kBar, 8, 0, 8, 6},
+  };
+  led_marquee::ZoneLayout layout(display_manager_, specs, 2, kTestFont,
+                                 &fields_, FakeTime);
+
+  EXPECT_TRUE(layout.Update(0));
+  // Nothing's changed, and the text isn't due until 100
+  EXPECT_EQ(layout.MsUntilDue(40), 60u);
+  EXPECT_FALSE(layout.Update(40));
+  // Due, but nothing in it changes by itself
+  EXPECT_FALSE(layout.Update(100));
+  EXPECT_EQ(layout.MsUntilDue(100), 100u);
+
+  layout.zone(1)->SetValue(100);
+  EXPECT_EQ(layout.MsUntilDue(120), 0u);
+  EXPECT_TRUE(layout.Update(120));
+  EXPECT_EQ(display_manager_.frame().Get(15, 5), Rgb({255, 255, 255}));
+}
+
+TEST_F(ZoneLayoutTest, CountsMissedUpdates) {
+  const ZoneSpec specs[] = {
+      {ZoneType::kText, 0, 0, 16, 6, nullptr, 100, "H"},
+  };
+  led_marquee::ZoneLayout layout(display_manager_, specs, 1, kTestFont,
+                                 &fields_, FakeTime);
+
+  layout.Update(0);
+  layout.Update(150);
+  EXPECT_EQ(layout.late_updates(), 0u);
+  // Due at 200, 300 and 400, so the first two were missed
+  layout.Update(420);
+  EXPECT_EQ(layout.late_updates(), 2u);
+  // Starts again from the late update
+  EXPECT_EQ(layout.MsUntilDue(420), 100u);
+}
+
+TEST_F(ZoneLayoutTest, KeepsFieldsUpToDate) {
+  fields_.WatchTopic("status");
+  fields_.SetTopic("status", "H");
+  const ZoneSpec specs[] = {
+      {ZoneType::kText, 0, 0, 16, 6, nullptr, 0, "{topic:status}"},
+  };
+  led_marquee::ZoneLayout layout(display_manager_, specs, 1, kTestFont,
+                                 &fields_, FakeTime);
+  auto &frame = display_manager_.frame();
+
+  layout.Update(0);
+  EXPECT_EQ(ColumnString(frame, 1), "..#...");
+
+  fields_.SetTopic("status", "I");
+  EXPECT_FALSE(layout.Update(100));
+  EXPECT_TRUE(layout.Update(led_marquee::ZoneLayout::kTextIntervalMs));
+  EXPECT_EQ(ColumnString(frame, 1), "#####.");
+}
+
+TEST_F(ZoneLayoutTest, ShowsTheClockOncePerInterval) {
+  // strftime() passes the letters through as they are
+  const ZoneSpec specs[] = {
+      {ZoneType::kClock, 0, 0, 16, 6, nullptr, 0, "I",
+       led_marquee::ClockZone::kCycleColors},
+  };
+  led_marquee::ZoneLayout layout(display_manager_, specs, 1, kTestFont,
+                                 &fields_, FakeTime);
+  auto &frame = display_manager_.frame();
+
+  EXPECT_TRUE(layout.Update(0));
+  EXPECT_EQ(ColumnString(frame, 1), "#####.");
+  const Rgb first = frame.Get(1, 1);
+
+  EXPECT_FALSE(layout.Update(999));
+  EXPECT_TRUE(layout.Update(1000));
+  // A little further around the color wheel
+  EXPECT_NE(frame.Get(1, 1), first);
+}
+
+TEST_F(ZoneLayoutTest, OnlyShowsTheClockWhenItChanges) {
+  const ZoneSpec specs[] = {
+      {ZoneType::kClock, 0, 0, 16, 6, nullptr, 0, "%S"},
+  };
+  led_marquee::ZoneLayout layout(display_manager_, specs, 1, kTestFont,
+                                 &fields_, FakeTime);
+
+  EXPECT_TRUE(layout.Update(0));
+  // Due, but it's the same second
+  EXPECT_FALSE(layout.Update(1000));
+  fake_time = 1;
+  EXPECT_TRUE(layout.Update(2000));
+}
+
+TEST_F(ZoneLayoutTest, ScrollsAtTheScrollSpeed) {
+  const ZoneSpec specs[] = {
+      {ZoneType::kScroller, 0, 0, 16, 6},
+  };
+  led_marquee::ZoneLayout layout(display_manager_, specs, 1, kTestFont,
+                                 &fields_, FakeTime);
+  layout.text().SetSpeed(40);
+  layout.text().ShowScrollText("H");
+
+  EXPECT_TRUE(layout.Update(0));
+  EXPECT_EQ(layout.MsUntilDue(0), 40u);
+  EXPECT_FALSE(layout.Update(39));
+  EXPECT_TRUE(layout.Update(40));
+}
+
+TEST_F(ZoneLayoutTest, CatchesUpAfterLateUpdates) {
+  led_marquee::DisplayManager on_time_display(
+      std::make_unique<led_marquee::HostOutput>(16, 6), 16, 6);
+  const ZoneSpec specs[] = {
+      {ZoneType::kScroller, 0, 0, 16, 6},
+  };
+  led_marquee::ZoneLayout on_time(on_time_display, specs, 1, kTestFont,
+                                  &fields_, FakeTime);
+  led_marquee::ZoneLayout late(display_manager_, specs, 1, kTestFont,
+                               &fields_, FakeTime);
+  for (auto *layout : {&on_time, &late}) {
+    layout->text().SetSpeed(40);
+    layout->text().ShowScrollText("HIH");
+    layout->Update(0);
+  }
+
+  for (uint32_t now = 40; now <= 200; now += 40) on_time.Update(now);
+  // A whole interval behind, then a bit late
+  late.Update(130);
+  late.Update(200);
+
+  // Missed the ones due at 80 and 120
+  EXPECT_EQ(late.late_updates(), 2u);
+  for (int x = 0; x < 16; x++) {
+    EXPECT_EQ(ColumnString(display_manager_.frame(), x),
+              ColumnString(on_time_display.frame(), x));
+  }
+}
+
+TEST_F(ZoneLayoutTest, DrawsBetweenColumnsWithABlendInterval) {
+  const ZoneSpec specs[] = {
+      {ZoneType::kScroller, 0, 0, 16, 6, nullptr, 10},
+  };
+  led_marquee::ZoneLayout layout(display_manager_, specs, 1, kTestFont,
+                                 &fields_, FakeTime);
+  layout.text().SetSpeed(40);
+  layout.text().ShowScrollText("H");
+
+  layout.Update(0);
+  EXPECT_EQ(layout.MsUntilDue(0), 10u);
+  EXPECT_TRUE(layout.Update(10));
+  EXPECT_TRUE(layout.Update(20));
+  EXPECT_TRUE(layout.Update(40));
+}
+
+TEST_F(ZoneLayoutTest, GivesTheScrollerTheWholeDisplay) {
+  const ZoneSpec specs[] = {
+      {ZoneType::kText, 0, 0, 8, 6, nullptr, 0, "H"},
+      {ZoneType::kScroller, 8, 0, 8, 6},
+  };
+  led_marquee::ZoneLayout layout(display_manager_, specs, 2, kTestFont,
+                                 &fields_, FakeTime);
+  layout.Update(0);
+
+  layout.FullScreen();
+  EXPECT_EQ(layout.zone(0), nullptr);
+  EXPECT_EQ(layout.zone(1), &layout.scroller());
+
+  layout.text().ShowStaticText("I");
+  EXPECT_EQ(ColumnString(display_manager_.frame(), 1), "#####.");
+}
+
+TEST_F(ZoneLayoutTest, AlwaysHasAScroller) {
+  const ZoneSpec specs[] = {
+      {ZoneType::kClock, 0, 0, 16, 6},
+  };
+  led_marquee::ZoneLayout layout(display_manager_, specs, 1, kTestFont,
+                                 &fields_, FakeTime);
+
+  // Takes up no room until it's needed
+  layout.text().ShowStaticText("H");
+  EXPECT_EQ(ColumnString(display_manager_.frame(), 0), "......");
+
+  layout.FullScreen();
+  layout.text().ShowStaticText("H");
+  EXPECT_EQ(ColumnString(display_manager_.frame(), 0), "#####.");
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  // if you plan to use GMock, replace the line above with
+  // ::testing::InitGoogleMock(&argc, argv);
+
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}